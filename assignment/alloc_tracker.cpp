@@ -0,0 +1,117 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Allocation tracking for tests and benchmarks
+//
+// $NoKeywords: $ivs_project_1 $alloc_tracker.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file alloc_tracker.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Nahrazeni globalniho operator new/delete a citace alokaci.
+ *
+ * Varianty new[], nothrow a delete[] ze standardni knihovny volaji tyto
+ * zakladni funkce, nahrazeny jsou i zarovnane varianty (std::align_val_t),
+ * ktere pouziva napr. DaryHeap.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "alloc_tracker.h"
+
+static std::atomic<size_t> g_allocations(0);
+static std::atomic<size_t> g_deallocations(0);
+static std::atomic<size_t> g_bytes(0);
+
+void *operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    void *p = malloc(size ? size : 1);
+
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p != NULL) {
+        g_deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    //aligned_alloc needs size to be a multiple of the alignment
+    size_t align = static_cast<size_t>(alignment);
+    size_t rounded = size ? (size + align - 1) / align * align : align;
+    void *p = aligned_alloc(align, rounded);
+
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+    operator delete(p);
+}
+
+AllocTracker::AllocTracker()
+{
+    restart();
+}
+
+void AllocTracker::restart()
+{
+    m_allocations = g_allocations.load(std::memory_order_relaxed);
+    m_deallocations = g_deallocations.load(std::memory_order_relaxed);
+    m_bytes = g_bytes.load(std::memory_order_relaxed);
+}
+
+size_t AllocTracker::allocations() const
+{
+    return g_allocations.load(std::memory_order_relaxed) - m_allocations;
+}
+
+size_t AllocTracker::deallocations() const
+{
+    return g_deallocations.load(std::memory_order_relaxed) - m_deallocations;
+}
+
+size_t AllocTracker::bytes() const
+{
+    return g_bytes.load(std::memory_order_relaxed) - m_bytes;
+}
+
+size_t AllocTracker::totalAllocations()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+/*** Konec souboru alloc_tracker.cpp ***/
@@ -0,0 +1,79 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Allocation tracking for tests and benchmarks
+//
+// $NoKeywords: $ivs_project_1 $alloc_tracker.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file alloc_tracker.h
+ * @author Lukáš Plevač
+ *
+ * @brief Pocitani alokaci pres nahrazeny globalni operator new/delete.
+ *
+ * alloc_tracker.cpp nahrazuje globalni operator new a delete, pridava se proto
+ * primo do zdroju testu nebo benchmarku, nikdy do knihoven.
+ *
+ * Pouziti v testu:
+ * @code
+ *     AllocTracker tracker;
+ *     mat.multiplyInto(other, result);
+ *     EXPECT_EQ(tracker.allocations(), 0);
+ * @endcode
+ */
+
+#pragma once
+
+#ifndef ALLOC_TRACKER_H_
+#define ALLOC_TRACKER_H_
+
+#include <cstddef>
+
+/**
+ * @brief The AllocTracker class
+ * Oblast mereni alokaci od vytvoreni objektu (nebo posledniho restart()).
+ * Citace jsou globalni, zapocitaji se tedy i alokace ostatnich vlaken.
+ */
+class AllocTracker
+{
+public:
+    AllocTracker();
+
+    /**
+     * @brief restart
+     * Zacne novou oblast mereni.
+     */
+    void restart();
+
+    /**
+     * @brief allocations
+     * @return Vraci pocet volani operator new v oblasti.
+     */
+    size_t allocations() const;
+
+    /**
+     * @brief deallocations
+     * @return Vraci pocet volani operator delete (s nenulovym ukazatelem) v oblasti.
+     */
+    size_t deallocations() const;
+
+    /**
+     * @brief bytes
+     * @return Vraci soucet pozadovanych velikosti alokaci v oblasti.
+     */
+    size_t bytes() const;
+
+    /**
+     * @brief totalAllocations
+     * @return Vraci pocet volani operator new od startu programu.
+     */
+    static size_t totalAllocations();
+
+protected:
+    size_t m_allocations;       ///< Pocet alokaci na zacatku oblasti.
+    size_t m_deallocations;     ///< Pocet dealokaci na zacatku oblasti.
+    size_t m_bytes;             ///< Alokovane bajty na zacatku oblasti.
+};
+
+#endif // ALLOC_TRACKER_H_
@@ -41,7 +41,7 @@ protected:
     virtual void SetUp() {
         int keys[] = { 10, 11, 12, 13, 14, 15, 16, 17, 18, -10000, 10000, 55, -82, 62, 95, 100 };
 
-        for(int i = 0; i < 17; ++i)
+        for(int i = 0; i < 16; ++i)
             EXPECT_EQ(tree.InsertNode(keys[i]).first, true);
     }
 
@@ -0,0 +1,531 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Lock-free concurrent priority queue
+//
+// $NoKeywords: $ivs_project_1 $concurrent_priority_queue.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file concurrent_priority_queue.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace lock-free prioritni fronty a sprava pameti pomoci epoch.
+ */
+
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "concurrent_priority_queue.h"
+#include "instrumentation.h"
+
+/**
+ * @brief The EpochManager class
+ * Epoch-based reclamation. Vlakno pred ctenim sdilene struktury ohlasi
+ * aktualni epochu, odebrane polozky se ukladaji s epochou odebrani a uvolni se,
+ * az globalni epocha postoupi o dve (vsechna vlakna, ktera mohla polozku
+ * videt, mezitim opustila kritickou sekci). Epocha postoupi, pokud vsechna
+ * aktivni vlakna ohlasila aktualni epochu.
+ */
+class EpochManager
+{
+public:
+    /**
+     * @brief The Record_t struct
+     * Zaznam vlakna, po skonceni vlakna jej muze prevzit jine vlakno.
+     */
+    struct Record_t {
+        std::atomic<uint64_t> epoch;        ///< (epocha << 1) | 1 v kriticke sekci, jinak 0.
+        std::atomic<bool> inUse;            ///< Zaznam patri zivemu vlaknu.
+        Record_t *pNext;                    ///< Dalsi zaznam v seznamu.
+        unsigned nesting;                   ///< Hloubka vnoreni kritickych sekci.
+        size_t retired;                     ///< Pocet odebranych polozek od posledniho pokusu o posun.
+        uint64_t limboEpoch[3];             ///< Epocha polozek v limbo[i].
+        std::vector<std::pair<void *, void (*)(void *)> > limbo[3];
+    };
+
+    static EpochManager &instance()
+    {
+        //never destroyed, threads may still hold records at exit
+        static EpochManager *pManager = new EpochManager;
+
+        return *pManager;
+    }
+
+    void enter()
+    {
+        Record_t *rec = record();
+
+        if (rec->nesting++ == 0) {
+            rec->epoch.store((m_epoch.load() << 1) | 1);
+        }
+    }
+
+    void leave()
+    {
+        Record_t *rec = record();
+
+        if (--rec->nesting == 0) {
+            rec->epoch.store(0);
+        }
+    }
+
+    /**
+     * @brief retire
+     * Zaradi vyjmutou polozku k pozdejsimu uvolneni, volat v kriticke sekci.
+     */
+    void retire(void *ptr, void (*deleter)(void *))
+    {
+        Record_t *rec = record();
+        uint64_t epoch = m_epoch.load();
+
+        collect(rec, epoch);
+
+        size_t bucket = epoch % 3;
+        rec->limboEpoch[bucket] = epoch;
+        rec->limbo[bucket].push_back(std::make_pair(ptr, deleter));
+
+        if (++rec->retired >= ADVANCE_PERIOD) {
+            rec->retired = 0;
+            tryAdvance(epoch);
+        }
+    }
+
+protected:
+    /**
+     * Pocet odebranych polozek mezi pokusy o posun epochy
+     */
+    static const size_t ADVANCE_PERIOD = 64;
+
+    /**
+     * @brief The ThreadRecord_t struct
+     * Drzi zaznam vlakna a pri skonceni vlakna jej uvolni.
+     */
+    struct ThreadRecord_t {
+        Record_t *pRecord = NULL;
+
+        ~ThreadRecord_t()
+        {
+            if (pRecord != NULL) {
+                pRecord->inUse.store(false);
+            }
+        }
+    };
+
+    EpochManager() : m_epoch(2), m_pRecords(NULL)
+    {
+    }
+
+    Record_t *record()
+    {
+        static thread_local ThreadRecord_t t_record;
+
+        if (t_record.pRecord == NULL) {
+            t_record.pRecord = acquire();
+        }
+
+        return t_record.pRecord;
+    }
+
+    Record_t *acquire()
+    {
+        //reuse record of finished thread, its limbo is freed later
+        for (Record_t *rec = m_pRecords.load(); rec != NULL; rec = rec->pNext) {
+            bool expected = false;
+
+            if (!rec->inUse.load() && rec->inUse.compare_exchange_strong(expected, true)) {
+                return rec;
+            }
+        }
+
+        Record_t *rec = new Record_t;
+        rec->epoch = 0;
+        rec->inUse = true;
+        rec->nesting = 0;
+        rec->retired = 0;
+
+        for (size_t i = 0; i < 3; i++) {
+            rec->limboEpoch[i] = 0;
+        }
+
+        rec->pNext = m_pRecords.load();
+        while (!m_pRecords.compare_exchange_weak(rec->pNext, rec)) {
+        }
+
+        return rec;
+    }
+
+    /**
+     * @brief collect
+     * Uvolni polozky odebrane nejmene dve epochy pred "epoch".
+     */
+    static void collect(Record_t *rec, uint64_t epoch)
+    {
+        for (size_t i = 0; i < 3; i++) {
+            if (rec->limbo[i].empty() || rec->limboEpoch[i] + 2 > epoch) {
+                continue;
+            }
+
+            for (size_t j = 0; j < rec->limbo[i].size(); j++) {
+                rec->limbo[i][j].second(rec->limbo[i][j].first);
+            }
+
+            rec->limbo[i].clear();
+        }
+    }
+
+    void tryAdvance(uint64_t epoch)
+    {
+        uint64_t active = (epoch << 1) | 1;
+
+        for (Record_t *rec = m_pRecords.load(); rec != NULL; rec = rec->pNext) {
+            uint64_t seen = rec->epoch.load();
+
+            if (seen != 0 && seen != active) {
+                return;
+            }
+        }
+
+        m_epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    std::atomic<uint64_t> m_epoch;          ///< Globalni epocha.
+    std::atomic<Record_t *> m_pRecords;     ///< Zaznamy vsech vlaken.
+};
+
+/**
+ * @brief The EpochGuard_t struct
+ * Kriticka sekce, po dobu jejiho trvani se neuvolni zadna videna polozka.
+ */
+struct EpochGuard_t {
+    EpochGuard_t() { EpochManager::instance().enter(); }
+    ~EpochGuard_t() { EpochManager::instance().leave(); }
+};
+
+/**
+ * @brief The Node_t struct
+ * Polozka skiplistu, za strukturou nasleduje "levels" ukazatelu next. Nejnizsi
+ * bit ukazatele next[i] znamena, ze polozka je na urovni i odebrana.
+ */
+struct ConcurrentPriorityQueue::Node_t {
+    int value;                              ///< Hodnota polozky.
+    uint64_t seq;                           ///< Poradi vlozeni.
+    int levels;                             ///< Pocet urovni.
+    std::atomic<int> owners;                ///< Vkladajici a odebirajici vlakno, ktere polozku jeste nepustily.
+    std::atomic<uintptr_t> next[1];         ///< Nasledovnici na urovnich 0 .. levels - 1.
+};
+
+typedef std::atomic<uintptr_t> Link_t;
+
+static inline bool isMarked(uintptr_t link)
+{
+    return (link & 1) != 0;
+}
+
+template <typename Node>
+static inline Node *toNode(uintptr_t link)
+{
+    return reinterpret_cast<Node *>(link & ~uintptr_t(1));
+}
+
+template <typename Node>
+static Node *createNode(int value, uint64_t seq, int levels)
+{
+    void *mem = ::operator new(sizeof(Node) + (levels - 1) * sizeof(Link_t));
+    Node *node = static_cast<Node *>(mem);
+
+    node->value = value;
+    node->seq = seq;
+    node->levels = levels;
+    new (&node->owners) std::atomic<int>(2);
+
+    for (int i = 0; i < levels; i++) {
+        new (&node->next[i]) Link_t(0);
+    }
+
+    return node;
+}
+
+static void destroyNode(void *node)
+{
+    //links are trivially destructible
+    ::operator delete(node);
+}
+
+/**
+ * @brief release
+ * Vkladajici nebo odebirajici vlakno polozku pusti. Polozka se preda epoch
+ * reclamation az po obou, vkladajici vlakno uz na ni nepripoji zadnou uroven
+ * a odebirajici ji vyjmulo ze vsech urovni, volat v kriticke sekci.
+ */
+template <typename Node>
+static void release(Node *node)
+{
+    if (node->owners.fetch_sub(1) == 1) {
+        EpochManager::instance().retire(node, destroyNode);
+    }
+}
+
+/**
+ * @brief randomLevel
+ * Vrati pocet urovni nove polozky, uroven i ma pravdepodobnost 2^-i.
+ */
+static int randomLevel(int maxLevel)
+{
+    static thread_local uint64_t t_state = 0;
+
+    if (t_state == 0) {
+        t_state = reinterpret_cast<uintptr_t>(&t_state) | 1;
+    }
+
+    //xorshift64
+    t_state ^= t_state << 13;
+    t_state ^= t_state >> 7;
+    t_state ^= t_state << 17;
+
+    int levels = 1;
+    uint64_t bits = t_state;
+
+    while (levels < maxLevel && (bits & 1)) {
+        levels++;
+        bits >>= 1;
+    }
+
+    return levels;
+}
+
+/**
+ * @brief precedes
+ * @return Vraci true, pokud polozka lezi v poradi pred klicem (value, seq).
+ */
+template <typename Node>
+static inline bool precedes(const Node *node, int value, uint64_t seq)
+{
+    return node->value > value || (node->value == value && node->seq < seq);
+}
+
+const int ConcurrentPriorityQueue::MAX_LEVEL;
+
+ConcurrentPriorityQueue::ConcurrentPriorityQueue()
+    : ConcurrentPriorityQueue(1)
+{
+}
+
+ConcurrentPriorityQueue::ConcurrentPriorityQueue(int minLevels)
+    : m_minLevels(std::min(std::max(minLevels, 1), int(MAX_LEVEL))), m_sequence(1), m_size(0)
+{
+    m_pHead = createNode<Node_t>(0, 0, MAX_LEVEL);
+}
+
+ConcurrentPriorityQueue::~ConcurrentPriorityQueue()
+{
+    //no concurrent access, every linked node is owned by the queue
+    Node_t *node = toNode<Node_t>(m_pHead->next[0].load());
+
+    while (node != NULL) {
+        Node_t *next = toNode<Node_t>(node->next[0].load());
+        destroyNode(node);
+        node = next;
+    }
+
+    destroyNode(m_pHead);
+}
+
+bool ConcurrentPriorityQueue::find(int value, uint64_t seq, Node_t **preds, Node_t **succs)
+{
+    IVS_TRACE_SCOPE("ConcurrentPriorityQueue::find");
+
+retry:
+    Node_t *pred = m_pHead;
+
+    for (int level = MAX_LEVEL - 1; level >= 0; level--) {
+        Node_t *curr = toNode<Node_t>(pred->next[level].load());
+
+        while (curr != NULL) {
+            uintptr_t succ = curr->next[level].load();
+
+            if (isMarked(succ)) {
+                //unlink removed node, restart if predecessor changed
+                uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+
+                if (!pred->next[level].compare_exchange_strong(expected, succ & ~uintptr_t(1))) {
+                    goto retry;
+                }
+
+                curr = toNode<Node_t>(succ);
+                continue;
+            }
+
+            if (!precedes(curr, value, seq)) {
+                break;
+            }
+
+            IVS_TRACE_STEPS(1);
+
+            pred = curr;
+            curr = toNode<Node_t>(succ);
+        }
+
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+
+    return succs[0] != NULL && succs[0]->value == value && succs[0]->seq == seq;
+}
+
+void ConcurrentPriorityQueue::Insert(int value)
+{
+    IVS_TRACE_SCOPE("ConcurrentPriorityQueue::Insert");
+
+    EpochGuard_t guard;
+    Node_t *preds[MAX_LEVEL];
+    Node_t *succs[MAX_LEVEL];
+
+    uint64_t seq = m_sequence.fetch_add(1);
+    int levels = std::max(randomLevel(MAX_LEVEL), m_minLevels);
+    Node_t *node = createNode<Node_t>(value, seq, levels);
+
+    //count before publishing, concurrent pop must not see size 0
+    m_size.fetch_add(1);
+
+    //bottom level makes the node visible
+    while (true) {
+        find(value, seq, preds, succs);
+
+        for (int i = 0; i < levels; i++) {
+            node->next[i].store(reinterpret_cast<uintptr_t>(succs[i]));
+        }
+
+        uintptr_t expected = reinterpret_cast<uintptr_t>(succs[0]);
+
+        if (preds[0]->next[0].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node))) {
+            break;
+        }
+    }
+
+    for (int i = 1; i < levels; i++) {
+        while (true) {
+            uintptr_t own = node->next[i].load();
+
+            //node was popped meanwhile, stop building upper levels
+            if (isMarked(own)) {
+                goto done;
+            }
+
+            uintptr_t succ = reinterpret_cast<uintptr_t>(succs[i]);
+
+            if (own != succ && !node->next[i].compare_exchange_strong(own, succ)) {
+                goto done;
+            }
+
+            uintptr_t expected = succ;
+
+            if (preds[i]->next[i].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node))) {
+                break;
+            }
+
+            if (!find(value, seq, preds, succs)) {
+                goto done;
+            }
+        }
+    }
+
+done:
+    //a pop that finished its cleanup before the last link landed left the
+    //node reachable, unlink it now that no more levels are linked
+    if (isMarked(node->next[0].load())) {
+        find(value, seq, preds, succs);
+    }
+
+    release(node);
+}
+
+bool ConcurrentPriorityQueue::PopTop(int *pValue)
+{
+    IVS_TRACE_SCOPE("ConcurrentPriorityQueue::PopTop");
+
+    EpochGuard_t guard;
+    Node_t *curr = toNode<Node_t>(m_pHead->next[0].load());
+
+    while (curr != NULL) {
+        uintptr_t succ = curr->next[0].load();
+
+        if (isMarked(succ)) {
+            //already taken by another thread
+            IVS_TRACE_STEPS(1);
+
+            curr = toNode<Node_t>(succ);
+            continue;
+        }
+
+        if (!curr->next[0].compare_exchange_strong(succ, succ | 1)) {
+            //successor changed or node taken, look at the same node again
+            continue;
+        }
+
+        //node is ours, mark upper levels and unlink it everywhere
+        for (int i = curr->levels - 1; i > 0; i--) {
+            curr->next[i].fetch_or(1);
+        }
+
+        if (pValue != NULL) {
+            *pValue = curr->value;
+        }
+
+        m_size.fetch_sub(1);
+
+        Node_t *preds[MAX_LEVEL];
+        Node_t *succs[MAX_LEVEL];
+        find(curr->value, curr->seq, preds, succs);
+
+        release(curr);
+
+        return true;
+    }
+
+    return false;
+}
+
+size_t ConcurrentPriorityQueue::PopTop(size_t k, int *pOut)
+{
+    size_t count = 0;
+
+    while (count < k && PopTop(pOut != NULL ? &pOut[count] : NULL)) {
+        count++;
+    }
+
+    return count;
+}
+
+bool ConcurrentPriorityQueue::Find(int value)
+{
+    IVS_TRACE_SCOPE("ConcurrentPriorityQueue::Find");
+
+    EpochGuard_t guard;
+    Node_t *preds[MAX_LEVEL];
+    Node_t *succs[MAX_LEVEL];
+
+    //sequence 0 precedes every node with the same value
+    find(value, 0, preds, succs);
+
+    for (Node_t *node = succs[0]; node != NULL && node->value == value; ) {
+        uintptr_t succ = node->next[0].load();
+
+        if (!isMarked(succ)) {
+            return true;
+        }
+
+        node = toNode<Node_t>(succ);
+    }
+
+    return false;
+}
+
+size_t ConcurrentPriorityQueue::Length() const
+{
+    return m_size.load();
+}
+
+/*** Konec souboru concurrent_priority_queue.cpp ***/
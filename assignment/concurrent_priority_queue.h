@@ -0,0 +1,127 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Lock-free concurrent priority queue
+//
+// $NoKeywords: $ivs_project_1 $concurrent_priority_queue.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file concurrent_priority_queue.h
+ * @author Lukáš Plevač
+ *
+ * @brief Definice vlaknove bezpecne prioritni fronty nad lock-free skiplistem.
+ */
+
+#pragma once
+
+#ifndef CONCURRENT_PRIORITY_QUEUE_H_
+#define CONCURRENT_PRIORITY_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+/**
+ * @brief The ConcurrentPriorityQueue class
+ * Prioritni fronta (maximum na vrcholu) pro soubezny pristup z vice vlaken bez
+ * globalniho zamku. Polozky jsou v lock-free skiplistu serazene od max po min,
+ * stejne hodnoty podle poradi vlozeni.
+ *
+ * Odebrani polozky ma dve faze: oznaceni ukazatele na nasledovnika na nejnizsi
+ * urovni (linearizacni bod, vitez CAS polozku vlastni) a nasledne vyjmuti ze
+ * vsech urovni. PopTop tak soutezi jen o prvni neoznacenou polozku.
+ *
+ * Pamet odebranych polozek se uvolnuje az ve chvili, kdy ji zadne vlakno
+ * nemuze cist (epoch-based reclamation sdilena vsemi frontami). Polozka se
+ * k uvolneni preda az potom, co ji odebirajici vlakno vyjme ze vsech urovni
+ * a vkladajici vlakno dokonci pripojovani vyssich urovni, podle toho, co
+ * skonci pozdeji.
+ *
+ * Length je pri soubeznych zmenach jen priblizna. Destruktor nesmi bezet
+ * soubezne s jinymi operacemi.
+ */
+class ConcurrentPriorityQueue
+{
+public:
+    /**
+     * @brief ConcurrentPriorityQueue
+     * Konstruktor, vytvori prazdnou frontu.
+     */
+    ConcurrentPriorityQueue();
+
+    /**
+     * @brief ~ConcurrentPriorityQueue
+     * Destruktor, odstrani vsechny polozky.
+     */
+    ~ConcurrentPriorityQueue();
+
+    ConcurrentPriorityQueue(const ConcurrentPriorityQueue &) = delete;
+    ConcurrentPriorityQueue &operator=(const ConcurrentPriorityQueue &) = delete;
+
+    /**
+     * @brief Insert
+     * Zaradi novou polozku s hodnotou "value", O(log n) ocekavane.
+     */
+    void Insert(int value);
+
+    /**
+     * @brief PopTop
+     * Odebere polozku s nejvetsi hodnotou.
+     * @param pValue Pokud neni NULL, zapise se sem hodnota odebrane polozky.
+     * @return Vrati false, pokud je fronta prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" polozek s nejvetsimi hodnotami (kazdou samostatne, mezi
+     * nimi mohou jina vlakna vkladat a odebirat).
+     * @param pOut Pole pro alespon "k" hodnot, nebo NULL.
+     * @return Vrati pocet odebranych polozek.
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief Find
+     * @return Vrati true, pokud je ve fronte polozka s hodnotou "value".
+     */
+    bool Find(int value);
+
+    /**
+     * @brief Length
+     * @return Vrati pocet polozek ve fronte.
+     */
+    size_t Length() const;
+
+protected:
+    struct Node_t;
+
+    /**
+     * @brief ConcurrentPriorityQueue
+     * Konstruktor, vytvori prazdnou frontu, jejiz polozky maji alespon
+     * "minLevels" urovni (vysoke veze pro zatezove testy).
+     */
+    explicit ConcurrentPriorityQueue(int minLevels);
+
+    /**
+     * Nejvyssi pocet urovni skiplistu (staci pro ~2^24 polozek)
+     */
+    static const int MAX_LEVEL = 24;
+
+    /**
+     * @brief find
+     * Najde predchudce a nasledovniky pozice klice (value, seq) na vsech
+     * urovnich, cestou vyjme oznacene polozky.
+     * @return Vrati true, pokud polozka s klicem na nejnizsi urovni existuje.
+     */
+    bool find(int value, uint64_t seq, Node_t **preds, Node_t **succs);
+
+    int m_minLevels;                        ///< Nejnizsi pocet urovni polozky.
+    Node_t *m_pHead;                        ///< Hlava skiplistu (MAX_LEVEL urovni).
+    std::atomic<uint64_t> m_sequence;       ///< Poradi vlozeni pro stejne hodnoty.
+    std::atomic<size_t> m_size;             ///< Pocet polozek.
+};
+
+#endif // CONCURRENT_PRIORITY_QUEUE_H_
@@ -0,0 +1,224 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Cache-aligned d-ary implicit heap
+//
+// $NoKeywords: $ivs_project_1 $dary_heap.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file dary_heap.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace d-arni haldy.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include <new>
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+#include "dary_heap.h"
+#include "instrumentation.h"
+
+/**
+ * Zarovnani pole haldy (radka cache)
+ */
+static const size_t HEAP_ALIGNMENT = 64;
+
+template <unsigned Arity>
+const size_t DaryHeap<Arity>::OFFSET;
+
+template <unsigned Arity>
+DaryHeap<Arity>::DaryHeap()
+    : m_pValues(NULL), m_size(0), m_capacity(0)
+{
+}
+
+template <unsigned Arity>
+DaryHeap<Arity>::~DaryHeap()
+{
+    if (m_pValues != NULL) {
+        ::operator delete(m_pValues, std::align_val_t(HEAP_ALIGNMENT));
+    }
+}
+
+template <unsigned Arity>
+void DaryHeap<Arity>::Reserve(size_t count)
+{
+    //root offset, values and one full child group past the last value
+    size_t needed = OFFSET + count + Arity;
+    needed = (needed + Arity - 1) / Arity * Arity;
+
+    if (needed <= m_capacity) {
+        return;
+    }
+
+    IVS_TRACE_SCOPE("DaryHeap::Reserve");
+    IVS_TRACE_ALLOCS(1);
+
+    int *values = static_cast<int *>(::operator new(needed * sizeof(int), std::align_val_t(HEAP_ALIGNMENT)));
+
+    if (m_pValues != NULL) {
+        memcpy(values, m_pValues, m_capacity * sizeof(int));
+        ::operator delete(m_pValues, std::align_val_t(HEAP_ALIGNMENT));
+    }
+
+    for (size_t i = m_capacity; i < needed; i++) {
+        values[i] = INT_MIN;
+    }
+
+    m_pValues = values;
+    m_capacity = needed;
+}
+
+template <>
+unsigned DaryHeap<2>::maxChild(const int *group)
+{
+    return group[1] > group[0] ? 1 : 0;
+}
+
+template <>
+unsigned DaryHeap<4>::maxChild(const int *group)
+{
+#ifdef __SSE4_1__
+    //horizontal max, then first lane equal to it
+    __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(group));
+    __m128i m = _mm_max_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, m)));
+
+    return __builtin_ctz(mask);
+#else
+    unsigned a = group[1] > group[0] ? 1 : 0;
+    unsigned b = group[3] > group[2] ? 3 : 2;
+
+    return group[b] > group[a] ? b : a;
+#endif
+}
+
+template <>
+unsigned DaryHeap<8>::maxChild(const int *group)
+{
+#ifdef __SSE4_1__
+    __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i *>(group));
+    __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i *>(group + 4));
+    __m128i m = _mm_max_epi32(lo, hi);
+    m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, m)))
+             | (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, m))) << 4);
+
+    return __builtin_ctz(mask);
+#else
+    unsigned best = 0;
+
+    for (unsigned i = 1; i < 8; i++) {
+        if (group[i] > group[best]) {
+            best = i;
+        }
+    }
+
+    return best;
+#endif
+}
+
+template <unsigned Arity>
+void DaryHeap<Arity>::Insert(int value)
+{
+    IVS_TRACE_SCOPE("DaryHeap::Insert");
+
+    if (OFFSET + m_size + Arity >= m_capacity) {
+        Reserve(m_size < 16 ? 32 : 2 * m_size);
+    }
+
+    size_t pos = m_size++;
+
+    //move parents down, parent of i is (i - 1) / Arity
+    while (pos > 0) {
+        size_t parent = (pos - 1) / Arity;
+
+        if (m_pValues[OFFSET + parent] >= value) {
+            break;
+        }
+
+        IVS_TRACE_STEPS(1);
+
+        m_pValues[OFFSET + pos] = m_pValues[OFFSET + parent];
+        pos = parent;
+    }
+
+    m_pValues[OFFSET + pos] = value;
+}
+
+template <unsigned Arity>
+void DaryHeap<Arity>::siftDown(int value)
+{
+    IVS_TRACE_SCOPE("DaryHeap::siftDown");
+
+    size_t pos = 0;
+
+    //free slots hold INT_MIN, a whole child group can always be read
+    while (Arity * pos + 1 < m_size) {
+        const int *group = &m_pValues[Arity * (pos + 1)];
+        size_t child = Arity * pos + 1 + maxChild(group);
+
+        if (m_pValues[OFFSET + child] <= value) {
+            break;
+        }
+
+        IVS_TRACE_STEPS(1);
+
+        m_pValues[OFFSET + pos] = m_pValues[OFFSET + child];
+        pos = child;
+    }
+
+    m_pValues[OFFSET + pos] = value;
+}
+
+template <unsigned Arity>
+bool DaryHeap<Arity>::PopTop(int *pValue)
+{
+    IVS_TRACE_SCOPE("DaryHeap::PopTop");
+
+    if (m_size == 0) {
+        return false;
+    }
+
+    if (pValue != NULL) {
+        *pValue = m_pValues[OFFSET];
+    }
+
+    int last = m_pValues[OFFSET + --m_size];
+    m_pValues[OFFSET + m_size] = INT_MIN;
+
+    if (m_size > 0) {
+        siftDown(last);
+    }
+
+    return true;
+}
+
+template <unsigned Arity>
+size_t DaryHeap<Arity>::PopTop(size_t k, int *pOut)
+{
+    size_t count = 0;
+
+    while (count < k && PopTop(pOut != NULL ? &pOut[count] : NULL)) {
+        count++;
+    }
+
+    return count;
+}
+
+template class DaryHeap<2>;
+template class DaryHeap<4>;
+template class DaryHeap<8>;
+
+/*** Konec souboru dary_heap.cpp ***/
@@ -0,0 +1,124 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Cache-aligned d-ary implicit heap
+//
+// $NoKeywords: $ivs_project_1 $dary_heap.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file dary_heap.h
+ * @author Lukáš Plevač
+ *
+ * @brief Definice d-arni implicitni haldy hodnot int se zarovnanymi skupinami
+ *        potomku.
+ */
+
+#pragma once
+
+#ifndef DARY_HEAP_H_
+#define DARY_HEAP_H_
+
+#include <stddef.h>
+
+/**
+ * @brief The DaryHeap class
+ * Prioritni fronta hodnot int (maximum na vrcholu) nad d-arni haldou v poli.
+ * Pole je posunute o Arity - 1 prvku a zarovnane na 64 B, potomci kazdeho uzlu
+ * tak lezi v jednom zarovnanem bloku Arity * 4 B (pro Arity <= 16 v jedne
+ * radce cache). Volna mista za posledni hodnotou obsahuji INT_MIN, nejvetsi
+ * potomek se proto hleda pres celou skupinu bez kontroly mezi (s SSE4.1
+ * vektorove, jinak skalarne).
+ *
+ * Proti binarni halde ma vyska log_d n, sift-down tedy pristupuje do
+ * log2(d)-krat mene radek cache za cenu d - 1 porovnani na uroven.
+ *
+ * @tparam Arity pocet potomku uzlu (2, 4 nebo 8)
+ */
+template <unsigned Arity>
+class DaryHeap
+{
+public:
+    /**
+     * @brief DaryHeap
+     * Konstruktor, vytvori prazdnou haldu.
+     */
+    DaryHeap();
+
+    /**
+     * @brief ~DaryHeap
+     * Destruktor, uvolni pole haldy.
+     */
+    ~DaryHeap();
+
+    DaryHeap(const DaryHeap &) = delete;
+    DaryHeap &operator=(const DaryHeap &) = delete;
+
+    /**
+     * @brief Insert
+     * Zaradi hodnotu "value", O(log_d n).
+     */
+    void Insert(int value);
+
+    /**
+     * @brief PopTop
+     * Odebere nejvetsi hodnotu, O(d log_d n).
+     * @param pValue Pokud neni NULL, zapise se sem odebrana hodnota.
+     * @return Vrati false, pokud je halda prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" nejvetsich hodnot.
+     * @param pOut Pole pro alespon "k" hodnot serazenych od max po min, nebo NULL.
+     * @return Vrati pocet odebranych hodnot.
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief Top
+     * @return Vrati ukazatel na nejvetsi hodnotu, nebo NULL pro prazdnou haldu.
+     */
+    const int *Top() const { return m_size > 0 ? &m_pValues[OFFSET] : NULL; }
+
+    /**
+     * @brief Length
+     * @return Vrati pocet hodnot v halde.
+     */
+    size_t Length() const { return m_size; }
+
+    /**
+     * @brief Reserve
+     * Pripravi pole pro alespon "count" hodnot.
+     */
+    void Reserve(size_t count);
+
+protected:
+    static_assert(Arity == 2 || Arity == 4 || Arity == 8, "Podporovana arita je 2, 4 nebo 8.");
+
+    /**
+     * Posun korene, prvni potomek uzlu i je na indexu Arity * (i + 1)
+     */
+    static const size_t OFFSET = Arity - 1;
+
+    /**
+     * @brief maxChild
+     * @return Vrati index (0 .. Arity - 1) nejvetsiho prvku zarovnane skupiny.
+     */
+    static unsigned maxChild(const int *group);
+
+    /**
+     * @brief siftDown
+     * Posune hodnotu "value" od korene smerem k listum na spravne misto.
+     */
+    void siftDown(int value);
+
+    int *m_pValues;             ///< Pole haldy zarovnane na 64 B, koren na OFFSET.
+    size_t m_size;              ///< Pocet hodnot.
+    size_t m_capacity;          ///< Delka pole (vcetne posunu a volnych mist).
+};
+
+typedef DaryHeap<4> QuaternaryHeap;
+
+#endif // DARY_HEAP_H_
@@ -0,0 +1,328 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Binary heap priority queue
+//
+// $NoKeywords: $ivs_project_1 $heap_priority_queue.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file heap_priority_queue.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace prioritni fronty nad binarni haldou.
+ */
+
+#include "heap_priority_queue.h"
+#include "instrumentation.h"
+
+const HeapPriorityQueue::Handle_t HeapPriorityQueue::INVALID_HANDLE;
+const unsigned HeapPriorityQueue::SLOT_BITS;
+const size_t HeapPriorityQueue::INVALID_SLOT;
+
+HeapPriorityQueue::HeapPriorityQueue()
+{
+}
+
+HeapPriorityQueue::HeapPriorityQueue(const int *pValues, size_t count)
+{
+    InsertMany(pValues, count);
+}
+
+HeapPriorityQueue::~HeapPriorityQueue()
+{
+}
+
+HeapPriorityQueue::Handle_t HeapPriorityQueue::Insert(int value)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::Insert");
+
+    Handle_t handle = append(value);
+    siftUp(m_heap.size() - 1);
+
+    return handle;
+}
+
+void HeapPriorityQueue::InsertMany(const int *pValues, size_t count, Handle_t *pHandles)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::InsertMany");
+
+    size_t first = m_heap.size();
+
+    //small batch into large heap, sift up is cheaper than rebuild
+    if (count < first / 2) {
+        for (size_t i = 0; i < count; i++) {
+            Handle_t handle = Insert(pValues[i]);
+
+            if (pHandles != NULL) {
+                pHandles[i] = handle;
+            }
+        }
+
+        return;
+    }
+
+    m_heap.reserve(first + count);
+    m_slots.reserve(first + count);
+
+    for (size_t i = 0; i < count; i++) {
+        Handle_t handle = append(pValues[i]);
+
+        if (pHandles != NULL) {
+            pHandles[i] = handle;
+        }
+    }
+
+    //Floyd: sift down all inner nodes from the last one, O(n + m)
+    for (size_t i = m_heap.size() / 2; i > 0; i--) {
+        siftDown(i - 1);
+    }
+}
+
+bool HeapPriorityQueue::Erase(Handle_t handle)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::Erase");
+
+    size_t slot = slotOf(handle);
+
+    if (slot == INVALID_SLOT) {
+        return false;
+    }
+
+    removeAt(m_positions[slot]);
+
+    return true;
+}
+
+bool HeapPriorityQueue::UpdatePriority(Handle_t handle, int value)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::UpdatePriority");
+
+    size_t slot = slotOf(handle);
+
+    if (slot == INVALID_SLOT) {
+        return false;
+    }
+
+    m_heap[m_positions[slot]].value = value;
+    restore(m_positions[slot]);
+
+    return true;
+}
+
+HeapPriorityQueue::Element_t *HeapPriorityQueue::Get(Handle_t handle)
+{
+    size_t slot = slotOf(handle);
+
+    if (slot == INVALID_SLOT) {
+        return NULL;
+    }
+
+    return &m_heap[m_positions[slot]];
+}
+
+size_t HeapPriorityQueue::slotOf(Handle_t handle) const
+{
+    size_t slot = size_t(handle & ((Handle_t(1) << SLOT_BITS) - 1));
+    uint32_t generation = uint32_t(handle >> SLOT_BITS);
+
+    //freed slot, or slot reused by a newer element
+    if (slot >= m_positions.size() || m_positions[slot] == INVALID_SLOT || m_generations[slot] != generation) {
+        return INVALID_SLOT;
+    }
+
+    return slot;
+}
+
+bool HeapPriorityQueue::PopTop(int *pValue)
+{
+    return PopTop(1, pValue) == 1;
+}
+
+size_t HeapPriorityQueue::PopTop(size_t k, int *pOut)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::PopTop");
+
+    size_t count = 0;
+
+    while (count < k && !m_heap.empty()) {
+        if (pOut != NULL) {
+            pOut[count] = m_heap[0].value;
+        }
+
+        removeAt(0);
+        count++;
+    }
+
+    return count;
+}
+
+size_t HeapPriorityQueue::DrainWhile(const std::function<bool(int)> &predicate, std::vector<int> &out)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::DrainWhile");
+
+    size_t count = 0;
+
+    while (!m_heap.empty() && predicate(m_heap[0].value)) {
+        out.push_back(m_heap[0].value);
+
+        removeAt(0);
+        count++;
+    }
+
+    return count;
+}
+
+bool HeapPriorityQueue::Remove(int value)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::Remove");
+
+    auto el = this->Find(value);
+
+    if (el == NULL) {
+        return false;
+    }
+
+    removeAt(el - m_heap.data());
+
+    return true;
+}
+
+HeapPriorityQueue::Element_t *HeapPriorityQueue::Find(int value)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::Find");
+
+    for (size_t i = 0; i < m_heap.size(); i++) {
+        IVS_TRACE_STEPS(1);
+
+        if (m_heap[i].value == value) {
+            return &m_heap[i];
+        }
+    }
+
+    return NULL;
+}
+
+size_t HeapPriorityQueue::Length()
+{
+    return m_heap.size();
+}
+
+HeapPriorityQueue::Element_t *HeapPriorityQueue::GetHead()
+{
+    if (m_heap.empty()) {
+        return NULL;
+    }
+
+    return &m_heap[0];
+}
+
+HeapPriorityQueue::Handle_t HeapPriorityQueue::append(int value)
+{
+    size_t slot;
+
+    if (m_freeSlots.empty()) {
+        slot = m_positions.size();
+        m_positions.push_back(INVALID_SLOT);
+        m_generations.push_back(0);
+    } else {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    Element_t el;
+    el.pNext = NULL;
+    el.value = value;
+
+    m_heap.push_back(el);
+    m_slots.push_back(slot);
+    m_positions[slot] = m_heap.size() - 1;
+
+    return (Handle_t(m_generations[slot]) << SLOT_BITS) | slot;
+}
+
+void HeapPriorityQueue::siftUp(size_t pos)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::siftUp");
+
+    Element_t el = m_heap[pos];
+    size_t slot = m_slots[pos];
+
+    //move parents down, insert element once at the end
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+
+        if (m_heap[parent].value >= el.value) {
+            break;
+        }
+
+        IVS_TRACE_STEPS(1);
+
+        place(pos, m_heap[parent], m_slots[parent]);
+        pos = parent;
+    }
+
+    place(pos, el, slot);
+}
+
+void HeapPriorityQueue::siftDown(size_t pos)
+{
+    IVS_TRACE_SCOPE("HeapPriorityQueue::siftDown");
+
+    size_t count = m_heap.size();
+    Element_t el = m_heap[pos];
+    size_t slot = m_slots[pos];
+
+    while (2 * pos + 1 < count) {
+        size_t child = 2 * pos + 1;
+
+        if (child + 1 < count && m_heap[child + 1].value > m_heap[child].value) {
+            child++;
+        }
+
+        if (m_heap[child].value <= el.value) {
+            break;
+        }
+
+        IVS_TRACE_STEPS(1);
+
+        place(pos, m_heap[child], m_slots[child]);
+        pos = child;
+    }
+
+    place(pos, el, slot);
+}
+
+void HeapPriorityQueue::restore(size_t pos)
+{
+    if (pos > 0 && m_heap[(pos - 1) / 2].value < m_heap[pos].value) {
+        siftUp(pos);
+    } else {
+        siftDown(pos);
+    }
+}
+
+void HeapPriorityQueue::removeAt(size_t pos)
+{
+    size_t last = m_heap.size() - 1;
+
+    //new generation makes all handles of the freed slot stale
+    size_t slot = m_slots[pos];
+    m_positions[slot] = INVALID_SLOT;
+    m_generations[slot]++;
+    m_freeSlots.push_back(slot);
+
+    if (pos != last) {
+        place(pos, m_heap[last], m_slots[last]);
+    }
+
+    m_heap.pop_back();
+    m_slots.pop_back();
+
+    if (pos != last) {
+        //moved element may belong above or below its new position
+        restore(pos);
+    }
+}
+
+/*** Konec souboru heap_priority_queue.cpp ***/
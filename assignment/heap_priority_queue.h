@@ -0,0 +1,244 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Binary heap priority queue
+//
+// $NoKeywords: $ivs_project_1 $heap_priority_queue.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file heap_priority_queue.h
+ * @author Lukáš Plevač
+ *
+ * @brief Definice prioritni fronty nad binarni haldou se stejnym rozhranim
+ *        jako PriorityQueue.
+ */
+
+#pragma once
+
+#ifndef HEAP_PRIORITY_QUEUE_H_
+#define HEAP_PRIORITY_QUEUE_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "tdd_code.h"
+
+/**
+ * @brief The HeapPriorityQueue class
+ * Prioritni fronta implementovana binarni haldou v poli (maximum na vrcholu).
+ * Nahrada tridy PriorityQueue se stejnym rozhranim: Insert a Remove maji
+ * slozitost O(log n) (Remove navic hleda polozku v O(n) pruchodem souvislym
+ * polem), GetHead O(1). Fronta muze obsahovat vice polozek se stejnou hodnotou.
+ *
+ * Polozky nejsou provazane, pNext je vzdy NULL. Ukazatele vracene z GetHead a
+ * Find plati jen do nasledujici zmeny fronty.
+ *
+ * Insert vraci stabilni handle polozky, pres ktery lze polozku odstranit
+ * (Erase) nebo zmenit jeji hodnotu (UpdatePriority) v O(log n) bez hledani.
+ * Handle plati do odstraneni polozky. Handle sklada index slotu (dolnich 32
+ * bitu) a generaci slotu (hornich 32 bitu), ktera se pri kazdem uvolneni
+ * slotu zvysi. Stary handle tak po znovupouziti slotu novou polozkou
+ * neodkazuje na nic (ABA se projevi az po 2^32 znovupouzitich jednoho slotu).
+ */
+class HeapPriorityQueue
+{
+public:
+    typedef PriorityQueue::Element_t Element_t;
+
+    /**
+     * Handle polozky ve fronte
+     */
+    typedef uint64_t Handle_t;
+
+    /**
+     * Handle, ktery neodkazuje na zadnou polozku
+     */
+    static const Handle_t INVALID_HANDLE = ~uint64_t(0);
+
+    /**
+     * @brief HeapPriorityQueue
+     * Konstruktor, vytvori prazdnou frontu.
+     */
+    HeapPriorityQueue();
+
+    /**
+     * @brief HeapPriorityQueue
+     * Konstruktor, vytvori haldu z hodnot "pValues" v O(n) (viz InsertMany).
+     * @param pValues Pole hodnot novych polozek.
+     * @param count Pocet hodnot.
+     */
+    HeapPriorityQueue(const int *pValues, size_t count);
+
+    /**
+     * @brief ~HeapPriorityQueue
+     * Destruktor, odstrani vsechny polozky.
+     */
+    ~HeapPriorityQueue();
+
+    /**
+     * @brief Insert
+     * Zaradi novou polozku s hodnotou "value" do haldy, O(log n).
+     * @param value Hodnota nove polozky.
+     * @return Vrati handle nove polozky.
+     */
+    Handle_t Insert(int value);
+
+    /**
+     * @brief InsertMany
+     * Zaradi najednou "count" polozek. Pri velke davce (alespon polovina
+     * soucasne delky) se cela halda prestavi zdola nahoru v O(n + m), jinak se
+     * polozky zaradi jednotlive v O(m log (n + m)).
+     * @param pValues Pole hodnot novych polozek.
+     * @param count Pocet hodnot.
+     * @param pHandles Pokud neni NULL, zapise se sem "count" handlu novych
+     * polozek ve stejnem poradi jako pValues.
+     */
+    void InsertMany(const int *pValues, size_t count, Handle_t *pHandles = NULL);
+
+    /**
+     * @brief Erase
+     * Odstrani polozku s handlem "handle", O(log n).
+     * @return Vrati false, pokud handle neodkazuje na polozku ve fronte.
+     */
+    bool Erase(Handle_t handle);
+
+    /**
+     * @brief UpdatePriority
+     * Zmeni hodnotu polozky s handlem "handle" a presune ji na spravne misto
+     * v halde (zvyseni i snizeni), O(log n). Handle zustava platny.
+     * @return Vrati false, pokud handle neodkazuje na polozku ve fronte.
+     */
+    bool UpdatePriority(Handle_t handle, int value);
+
+    /**
+     * @brief Get
+     * @return Vrati ukazatel na polozku s handlem "handle", nebo NULL pokud
+     * handle neodkazuje na polozku ve fronte.
+     */
+    Element_t *Get(Handle_t handle);
+
+    /**
+     * @brief PopTop
+     * Odebere polozku s nejvetsi hodnotou.
+     * @param pValue Pokud neni NULL, zapise se sem hodnota odebrane polozky.
+     * @return Vrati false, pokud je fronta prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" polozek s nejvetsimi hodnotami v O(k log n).
+     * @param k Nejvetsi pocet odebranych polozek.
+     * @param pOut Pole pro alespon "k" hodnot serazenych od max po min, nebo NULL.
+     * @return Vrati pocet odebranych polozek (mene nez k jen pri vyprazdneni fronty).
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief DrainWhile
+     * Odebira polozky od nejvetsi, dokud pro hodnotu na vrcholu plati
+     * "predicate", a pridava jejich hodnoty na konec "out".
+     * @return Vrati pocet odebranych polozek.
+     */
+    size_t DrainWhile(const std::function<bool(int)> &predicate, std::vector<int> &out);
+
+    /**
+     * @brief Remove
+     * Odstrani libovolnou polozku s hodnotou "value".
+     * @param value Hodnota polozky, ktera ma byt odstranena.
+     * @return Vrati true, pokud byla polozka nalezena a odstranena, jinak vraci false.
+     */
+    bool Remove(int value);
+
+    /**
+     * @brief Find
+     * @param value Hodnota hledane polozky.
+     * @return Vrati ukazatel na libovolnou polozku s hodnotou "value", nebo
+     * NULL pokud takova neexistuje.
+     */
+    Element_t *Find(int value);
+
+    /**
+     * @brief Length
+     * @return Vrati delku fronty, O(1).
+     */
+    size_t Length();
+
+    /**
+     * @brief GetHead
+     * @return Vraci ukazatel na polozku s nejvetsi hodnotou, nebo NULL, pokud
+     * je fronta prazdna.
+     */
+    Element_t *GetHead();
+
+protected:
+    /**
+     * @brief append
+     * Prida polozku na konec pole bez obnoveni haldy.
+     * @return Vrati handle nove polozky.
+     */
+    Handle_t append(int value);
+
+    /**
+     * @brief siftUp
+     * Posune polozku na indexu pos smerem ke koreni na spravne misto.
+     */
+    void siftUp(size_t pos);
+
+    /**
+     * @brief siftDown
+     * Posune polozku na indexu pos smerem k listum na spravne misto.
+     */
+    void siftDown(size_t pos);
+
+    /**
+     * @brief restore
+     * Posune polozku na indexu pos nahoru nebo dolu podle jejiho rodice.
+     */
+    void restore(size_t pos);
+
+    /**
+     * Pocet bitu indexu slotu v handlu
+     */
+    static const unsigned SLOT_BITS = 32;
+
+    /**
+     * Pozice volneho slotu, vysledek slotOf pro neplatny handle
+     */
+    static const size_t INVALID_SLOT = ~size_t(0);
+
+    /**
+     * @brief slotOf
+     * @return Vrati index slotu handlu, nebo INVALID_SLOT pokud handle
+     * neodkazuje na polozku ve fronte (neplatny nebo stare generace).
+     */
+    size_t slotOf(Handle_t handle) const;
+
+    /**
+     * @brief place
+     * Ulozi polozku a jeji slot na index pos a aktualizuje pozici slotu.
+     */
+    void place(size_t pos, const Element_t &el, size_t slot)
+    {
+        m_heap[pos] = el;
+        m_slots[pos] = slot;
+        m_positions[slot] = pos;
+    }
+
+    /**
+     * @brief removeAt
+     * Odstrani polozku na indexu pos, na jeji misto presune posledni polozku.
+     */
+    void removeAt(size_t pos);
+
+    std::vector<Element_t> m_heap;          ///< Halda v poli, potomci i jsou 2i+1 a 2i+2.
+    std::vector<size_t> m_slots;            ///< Slot polozky na danem indexu haldy.
+    std::vector<size_t> m_positions;        ///< Index v halde pro slot (INVALID_SLOT pro volny).
+    std::vector<uint32_t> m_generations;    ///< Generace slotu, zvysi se pri uvolneni.
+    std::vector<size_t> m_freeSlots;        ///< Uvolnene sloty k dalsimu pouziti.
+};
+
+#endif // HEAP_PRIORITY_QUEUE_H_
@@ -0,0 +1,158 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Hot-path tracing counters
+//
+// $NoKeywords: $ivs_project_1 $instrumentation.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file instrumentation.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace registrace a exportu citacu.
+ */
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+#include "instrumentation.h"
+
+/**
+ * Hlava seznamu vsech citacu, citace se pouze pridavaji (zaniknou s programem)
+ */
+static std::atomic<TraceCounter_t *> g_pCounters(nullptr);
+
+/**
+ * @brief The TraceTotals_t struct
+ * Soucet citacu stejneho jmena pro export.
+ */
+struct TraceTotals_t {
+    uint64_t calls = 0;
+    uint64_t nanos = 0;
+    uint64_t maxNanos = 0;
+    uint64_t flops = 0;
+    uint64_t bytes = 0;
+    uint64_t allocs = 0;
+    uint64_t steps = 0;
+};
+
+TraceCounter_t::TraceCounter_t(const char *name)
+    : name(name), calls(0), nanos(0), maxNanos(0), flops(0), bytes(0), allocs(0), steps(0)
+{
+    pNext = g_pCounters.load(std::memory_order_relaxed);
+
+    while (!g_pCounters.compare_exchange_weak(pNext, this, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    uint64_t elapsed = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start).count());
+
+    TraceCounter_t::add(m_counter.calls, 1);
+    TraceCounter_t::add(m_counter.nanos, elapsed);
+
+    uint64_t max = m_counter.maxNanos.load(std::memory_order_relaxed);
+
+    while (elapsed > max && !m_counter.maxNanos.compare_exchange_weak(max, elapsed,
+                                                                      std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief collect
+ * @return Vraci soucty citacu podle jmena.
+ */
+static std::map<std::string, TraceTotals_t> collect()
+{
+    std::map<std::string, TraceTotals_t> totals;
+
+    for (TraceCounter_t *c = g_pCounters.load(std::memory_order_acquire); c != nullptr; c = c->pNext) {
+        TraceTotals_t &t = totals[c->name];
+
+        t.calls += c->calls.load(std::memory_order_relaxed);
+        t.nanos += c->nanos.load(std::memory_order_relaxed);
+        t.maxNanos = std::max(t.maxNanos, c->maxNanos.load(std::memory_order_relaxed));
+        t.flops += c->flops.load(std::memory_order_relaxed);
+        t.bytes += c->bytes.load(std::memory_order_relaxed);
+        t.allocs += c->allocs.load(std::memory_order_relaxed);
+        t.steps += c->steps.load(std::memory_order_relaxed);
+    }
+
+    return totals;
+}
+
+std::string Instrumentation::toJson()
+{
+    std::ostringstream out;
+    bool first = true;
+
+    out << "{";
+
+    for (const auto &entry : collect()) {
+        const TraceTotals_t &t = entry.second;
+
+        out << (first ? "" : ",") << "\n  \"" << entry.first << "\": {"
+            << "\"calls\": " << t.calls
+            << ", \"ns\": " << t.nanos
+            << ", \"max_ns\": " << t.maxNanos
+            << ", \"flops\": " << t.flops
+            << ", \"bytes\": " << t.bytes
+            << ", \"allocs\": " << t.allocs
+            << ", \"steps\": " << t.steps << "}";
+
+        first = false;
+    }
+
+    out << (first ? "}" : "\n}");
+
+    return out.str();
+}
+
+std::string Instrumentation::toPerf()
+{
+    std::ostringstream out;
+
+    for (const auto &entry : collect()) {
+        const TraceTotals_t &t = entry.second;
+        const std::pair<const char *, uint64_t> fields[] = {
+            {"calls", t.calls}, {"ns", t.nanos}, {"max_ns", t.maxNanos}, {"flops", t.flops},
+            {"bytes", t.bytes}, {"allocs", t.allocs}, {"steps", t.steps}
+        };
+
+        for (const auto &field : fields) {
+            out.width(20);
+            out << field.second << "      " << entry.first << ":" << field.first << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+void Instrumentation::reset()
+{
+    for (TraceCounter_t *c = g_pCounters.load(std::memory_order_acquire); c != nullptr; c = c->pNext) {
+        c->calls.store(0, std::memory_order_relaxed);
+        c->nanos.store(0, std::memory_order_relaxed);
+        c->maxNanos.store(0, std::memory_order_relaxed);
+        c->flops.store(0, std::memory_order_relaxed);
+        c->bytes.store(0, std::memory_order_relaxed);
+        c->allocs.store(0, std::memory_order_relaxed);
+        c->steps.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool Instrumentation::enabled()
+{
+#ifdef IVS_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*** Konec souboru instrumentation.cpp ***/
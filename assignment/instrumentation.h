@@ -0,0 +1,149 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Hot-path tracing counters
+//
+// $NoKeywords: $ivs_project_1 $instrumentation.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file instrumentation.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace merici vrstvy (casovace, citace volani, operaci, bajtu,
+ *        alokaci a delek pruchodu).
+ *
+ * Mereni se zapina makrem IVS_INSTRUMENTATION (volba CMake IVS_INSTRUMENTATION),
+ * bez nej se vsechna makra IVS_TRACE_* prelozi na prazdny prikaz a jejich
+ * argumenty se nevyhodnocuji.
+ *
+ * IVS_TRACE_ALLOCS se vola primo u skutecne alokace (novy blok, zvetseni
+ * pole), ne jako odhad za celou operaci. Operace, ktere alokuji pres vice
+ * kontejneru (matice, LU rozklad), alokace nehlasi, celkovy pocet alokaci
+ * meri AllocTracker v testech a benchmarcich.
+ *
+ * Pouziti ve funkci:
+ * @code
+ *     IVS_TRACE_SCOPE("Matrix::operator+");
+ *     IVS_TRACE_FLOPS(rows * cols);
+ * @endcode
+ */
+
+#pragma once
+
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief The TraceCounter_t struct
+ * Citace jednoho mericiho mista. Instance jsou staticke a pri prvnim pouziti
+ * se zaradi do globalniho seznamu, ze ktereho se exportuji.
+ */
+struct TraceCounter_t
+{
+    /**
+     * @brief TraceCounter_t
+     * Konstruktor, zaradi citac do globalniho seznamu.
+     * @param name jmeno mericiho mista (retezcovy literal)
+     */
+    explicit TraceCounter_t(const char *name);
+
+    /**
+     * @brief add
+     * Pricte hodnotu k citaci (relaxed, citace nejsou synchronizacni body).
+     */
+    static void add(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    const char *name;                   ///< Jmeno mericiho mista.
+    std::atomic<uint64_t> calls;        ///< Pocet volani.
+    std::atomic<uint64_t> nanos;        ///< Celkovy cas volani [ns].
+    std::atomic<uint64_t> maxNanos;     ///< Nejdelsi volani [ns].
+    std::atomic<uint64_t> flops;        ///< Operace s plovouci carkou.
+    std::atomic<uint64_t> bytes;        ///< Prenesene bajty.
+    std::atomic<uint64_t> allocs;       ///< Alokace hlasene v miste alokace.
+    std::atomic<uint64_t> steps;        ///< Kroky pruchodu (navstivene prvky).
+    TraceCounter_t *pNext;              ///< Dalsi citac v globalnim seznamu.
+};
+
+/**
+ * @brief The TraceScope class
+ * Casovac oblasti, pri zaniku pricte pocet volani a dobu behu k citaci.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(TraceCounter_t &counter)
+        : m_counter(counter), m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~TraceScope();
+
+protected:
+    TraceCounter_t &m_counter;                          ///< Citac oblasti.
+    std::chrono::steady_clock::time_point m_start;      ///< Zacatek oblasti.
+};
+
+/**
+ * @brief The Instrumentation class
+ * Export a nulovani vsech citacu. Bez IVS_INSTRUMENTATION jsou exporty prazdne.
+ */
+class Instrumentation
+{
+public:
+    /**
+     * @brief toJson
+     * @return Vraci citace jako JSON objekt {"jmeno": {"calls": ..., ...}, ...},
+     *         citace stejneho jmena (napr. instance sablon) jsou secteny.
+     */
+    static std::string toJson();
+
+    /**
+     * @brief toPerf
+     * @return Vraci citace ve formatu podobnem "perf stat" (hodnota, jmeno:citac),
+     *         jeden citac na radek.
+     */
+    static std::string toPerf();
+
+    /**
+     * @brief reset
+     * Vynuluje vsechny citace.
+     */
+    static void reset();
+
+    /**
+     * @brief enabled
+     * @return Vraci true, pokud je knihovna prelozena s IVS_INSTRUMENTATION.
+     */
+    static bool enabled();
+};
+
+#ifdef IVS_INSTRUMENTATION
+
+#define IVS_TRACE_SCOPE(name) \
+    static TraceCounter_t ivsTraceCounter(name); \
+    TraceScope ivsTraceScope(ivsTraceCounter)
+#define IVS_TRACE_FLOPS(n)  TraceCounter_t::add(ivsTraceCounter.flops, uint64_t(n))
+#define IVS_TRACE_BYTES(n)  TraceCounter_t::add(ivsTraceCounter.bytes, uint64_t(n))
+#define IVS_TRACE_ALLOCS(n) TraceCounter_t::add(ivsTraceCounter.allocs, uint64_t(n))
+#define IVS_TRACE_STEPS(n)  TraceCounter_t::add(ivsTraceCounter.steps, uint64_t(n))
+
+#else
+
+#define IVS_TRACE_SCOPE(name) ((void)0)
+#define IVS_TRACE_FLOPS(n)  ((void)0)
+#define IVS_TRACE_BYTES(n)  ((void)0)
+#define IVS_TRACE_ALLOCS(n) ((void)0)
+#define IVS_TRACE_STEPS(n)  ((void)0)
+
+#endif // IVS_INSTRUMENTATION
+
+#endif // INSTRUMENTATION_H_
@@ -0,0 +1,269 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Radix heap and bucket queue for integer priorities
+//
+// $NoKeywords: $ivs_project_1 $integer_queues.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file integer_queues.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace radix haldy a bucket queue.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "integer_queues.h"
+#include "instrumentation.h"
+
+/**
+ * @brief highestBit
+ * @return Vraci index nejvyssiho nastaveneho bitu, "bits" nesmi byt 0.
+ */
+static inline unsigned highestBit(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - unsigned(__builtin_clzll(bits));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, bits);
+
+    return unsigned(index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+
+    if (_BitScanReverse(&index, static_cast<unsigned long>(bits >> 32))) {
+        return unsigned(index) + 32;
+    }
+
+    _BitScanReverse(&index, static_cast<unsigned long>(bits));
+
+    return unsigned(index);
+#else
+    unsigned index = 0;
+
+    while (bits >>= 1) {
+        index++;
+    }
+
+    return index;
+#endif
+}
+
+/**
+ * @brief toKey
+ * @return Vraci klic hodnoty, vetsi hodnota ma mensi klic bez znamenka.
+ */
+static inline uint32_t toKey(int value)
+{
+    return ~(uint32_t(value) ^ 0x80000000u);
+}
+
+static inline int fromKey(uint32_t key)
+{
+    return int(~key ^ 0x80000000u);
+}
+
+RadixHeap::RadixHeap()
+    : m_last(0), m_size(0)
+{
+}
+
+size_t RadixHeap::bucketOf(uint32_t key) const
+{
+    if (key == m_last) {
+        return 0;
+    }
+
+    //index of highest differing bit + 1
+    return highestBit(key ^ m_last) + 1;
+}
+
+bool RadixHeap::Insert(int value)
+{
+    uint32_t key = toKey(value);
+
+    if (key < m_last) {
+        return false;
+    }
+
+    m_buckets[bucketOf(key)].push_back(key);
+    m_size++;
+
+    return true;
+}
+
+bool RadixHeap::PopTop(int *pValue)
+{
+    IVS_TRACE_SCOPE("RadixHeap::PopTop");
+
+    if (m_size == 0) {
+        return false;
+    }
+
+    if (m_buckets[0].empty()) {
+        size_t i = 1;
+
+        while (m_buckets[i].empty()) {
+            i++;
+        }
+
+        //smallest key becomes new base, rest of bucket moves to lower buckets
+        std::vector<uint32_t> &bucket = m_buckets[i];
+        m_last = *std::min_element(bucket.begin(), bucket.end());
+
+        for (size_t j = 0; j < bucket.size(); j++) {
+            IVS_TRACE_STEPS(1);
+
+            m_buckets[bucketOf(bucket[j])].push_back(bucket[j]);
+        }
+
+        bucket.clear();
+    }
+
+    if (pValue != NULL) {
+        *pValue = fromKey(m_buckets[0].back());
+    }
+
+    m_buckets[0].pop_back();
+    m_size--;
+
+    return true;
+}
+
+size_t RadixHeap::PopTop(size_t k, int *pOut)
+{
+    size_t count = 0;
+
+    while (count < k && PopTop(pOut != NULL ? &pOut[count] : NULL)) {
+        count++;
+    }
+
+    return count;
+}
+
+int RadixHeap::Limit() const
+{
+    return fromKey(m_last);
+}
+
+BucketQueue::BucketQueue(int minValue, int maxValue)
+    : m_min(minValue), m_top(0), m_size(0)
+{
+    if (maxValue < minValue) {
+        throw std::runtime_error("Rozsah fronty je prazdny.");
+    }
+
+    size_t count = size_t(int64_t(maxValue) - int64_t(minValue)) + 1;
+
+    m_counts.assign(count, 0);
+    m_occupied.assign((count + 63) / 64, 0);
+}
+
+bool BucketQueue::Insert(int value)
+{
+    int64_t offset = int64_t(value) - m_min;
+
+    if (offset < 0 || uint64_t(offset) >= m_counts.size()) {
+        return false;
+    }
+
+    size_t index = size_t(offset);
+
+    if (m_counts[index]++ == 0) {
+        m_occupied[index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    if (m_size == 0 || index > m_top) {
+        m_top = index;
+    }
+
+    m_size++;
+
+    return true;
+}
+
+bool BucketQueue::Remove(int value)
+{
+    int64_t offset = int64_t(value) - m_min;
+
+    if (offset < 0 || uint64_t(offset) >= m_counts.size() || m_counts[size_t(offset)] == 0) {
+        return false;
+    }
+
+    size_t index = size_t(offset);
+    m_size--;
+
+    if (--m_counts[index] == 0) {
+        m_occupied[index / 64] &= ~(uint64_t(1) << (index % 64));
+
+        if (index == m_top && m_size > 0) {
+            findTop();
+        }
+    }
+
+    return true;
+}
+
+size_t BucketQueue::Find(int value) const
+{
+    int64_t offset = int64_t(value) - m_min;
+
+    if (offset < 0 || uint64_t(offset) >= m_counts.size()) {
+        return 0;
+    }
+
+    return m_counts[size_t(offset)];
+}
+
+bool BucketQueue::PopTop(int *pValue)
+{
+    if (m_size == 0) {
+        return false;
+    }
+
+    int value = int(int64_t(m_top) + m_min);
+
+    if (pValue != NULL) {
+        *pValue = value;
+    }
+
+    return Remove(value);
+}
+
+size_t BucketQueue::PopTop(size_t k, int *pOut)
+{
+    size_t count = 0;
+
+    while (count < k && PopTop(pOut != NULL ? &pOut[count] : NULL)) {
+        count++;
+    }
+
+    return count;
+}
+
+void BucketQueue::findTop()
+{
+    IVS_TRACE_SCOPE("BucketQueue::findTop");
+
+    //bits at or below old top, one word of 64 buckets at a time
+    size_t word = m_top / 64;
+    uint64_t bits = m_occupied[word] & (~uint64_t(0) >> (63 - m_top % 64));
+
+    while (bits == 0) {
+        IVS_TRACE_STEPS(1);
+
+        bits = m_occupied[--word];
+    }
+
+    m_top = word * 64 + highestBit(bits);
+}
+
+/*** Konec souboru integer_queues.cpp ***/
@@ -0,0 +1,166 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Radix heap and bucket queue for integer priorities
+//
+// $NoKeywords: $ivs_project_1 $integer_queues.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file integer_queues.h
+ * @author Lukáš Plevač
+ *
+ * @brief Definice prioritnich front specializovanych na celociselne hodnoty:
+ *        monotonni radix halda a bucket queue pro omezeny rozsah hodnot.
+ */
+
+#pragma once
+
+#ifndef INTEGER_QUEUES_H_
+#define INTEGER_QUEUES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * @brief The RadixHeap class
+ * Monotonni radix halda (maximum na vrcholu). Odebirane hodnoty nesmi rust:
+ * vkladana hodnota nesmi byt vetsi nez posledni odebrana (typicky Dijkstra
+ * nebo casovace pri obracenem poradi). Polozky jsou v 33 kosich podle nejvyssiho
+ * bitu, ve kterem se lisi od posledni odebrane hodnoty, kazda polozka se mezi
+ * kosi presune nejvyse 32krat: Insert O(1), PopTop amortizovane O(log C).
+ */
+class RadixHeap
+{
+public:
+    /**
+     * @brief RadixHeap
+     * Konstruktor, vytvori prazdnou haldu.
+     */
+    RadixHeap();
+
+    /**
+     * @brief Insert
+     * Zaradi hodnotu "value", O(1).
+     * @return Vrati false a hodnotu nezaradi, pokud je vetsi nez posledni
+     * odebrana hodnota (poruseni monotonie).
+     */
+    bool Insert(int value);
+
+    /**
+     * @brief PopTop
+     * Odebere nejvetsi hodnotu, amortizovane O(log C).
+     * @param pValue Pokud neni NULL, zapise se sem odebrana hodnota.
+     * @return Vrati false, pokud je halda prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" nejvetsich hodnot.
+     * @param pOut Pole pro alespon "k" hodnot serazenych od max po min, nebo NULL.
+     * @return Vrati pocet odebranych hodnot.
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief Length
+     * @return Vrati pocet hodnot v halde.
+     */
+    size_t Length() const { return m_size; }
+
+    /**
+     * @brief Limit
+     * @return Vrati nejvetsi hodnotu, kterou lze vlozit (posledni odebranou).
+     */
+    int Limit() const;
+
+protected:
+    /**
+     * @brief bucketOf
+     * @return Vrati index kose pro klic "key" vzhledem k m_last.
+     */
+    size_t bucketOf(uint32_t key) const;
+
+    std::vector<uint32_t> m_buckets[33];    ///< Klice (~hodnota v poradi bez znamenka) po kosich.
+    uint32_t m_last;                        ///< Klic posledni odebrane hodnoty.
+    size_t m_size;                          ///< Pocet hodnot.
+};
+
+/**
+ * @brief The BucketQueue class
+ * Prioritni fronta pro hodnoty ze znameho rozsahu [minValue, maxValue]
+ * (maximum na vrcholu). Pro kazdou hodnotu drzi pocet vyskytu a bitmapu
+ * neprazdnych kosu: Insert, Remove a Find O(1), PopTop hleda dalsi neprazdny
+ * kos po 64 hodnotach, tedy O(1) pri odebirani po sobe jdoucich hodnot a
+ * nejhure O(C / 64).
+ */
+class BucketQueue
+{
+public:
+    /**
+     * @brief BucketQueue
+     * Konstruktor, vytvori prazdnou frontu pro hodnoty minValue .. maxValue.
+     * @throws std::runtime_error pro maxValue < minValue
+     */
+    BucketQueue(int minValue, int maxValue);
+
+    /**
+     * @brief Insert
+     * Zaradi hodnotu "value", O(1).
+     * @return Vrati false a hodnotu nezaradi, pokud je mimo rozsah fronty.
+     */
+    bool Insert(int value);
+
+    /**
+     * @brief Remove
+     * Odstrani jeden vyskyt hodnoty "value", O(1).
+     * @return Vrati false, pokud hodnota ve fronte neni.
+     */
+    bool Remove(int value);
+
+    /**
+     * @brief Find
+     * @return Vrati pocet vyskytu hodnoty "value", O(1).
+     */
+    size_t Find(int value) const;
+
+    /**
+     * @brief PopTop
+     * Odebere nejvetsi hodnotu.
+     * @param pValue Pokud neni NULL, zapise se sem odebrana hodnota.
+     * @return Vrati false, pokud je fronta prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" nejvetsich hodnot.
+     * @param pOut Pole pro alespon "k" hodnot serazenych od max po min, nebo NULL.
+     * @return Vrati pocet odebranych hodnot.
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief Length
+     * @return Vrati pocet hodnot ve fronte.
+     */
+    size_t Length() const { return m_size; }
+
+protected:
+    /**
+     * @brief findTop
+     * Najde nejvyssi neprazdny kos nejvyse na indexu m_top.
+     */
+    void findTop();
+
+    int m_min;                              ///< Nejmensi hodnota rozsahu.
+    std::vector<uint32_t> m_counts;         ///< Pocet vyskytu kazde hodnoty.
+    std::vector<uint64_t> m_occupied;       ///< Bitmapa neprazdnych kosu.
+    size_t m_top;                           ///< Index nejvyssiho neprazdneho kose (platny pro m_size > 0).
+    size_t m_size;                          ///< Pocet hodnot.
+};
+
+#endif // INTEGER_QUEUES_H_
@@ -0,0 +1,321 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Parallel blocked LU decomposition
+//
+// $NoKeywords: $ivs_project_1 $lu_decomposition.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file lu_decomposition.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace blokove LU dekompozice nad planovacem uloh.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+#include "lu_decomposition.h"
+
+/**
+ * Vychozi sirka sloupcoveho bloku
+ */
+static const size_t DEFAULT_BLOCK_SIZE = 64;
+
+/**
+ * @brief isZeroPivot
+ * @param value pivot
+ * @return Vraci true, pokud je pivot mensi nez strojove epsilon
+ */
+template <typename T>
+static bool isZeroPivot(const T &value)
+{
+    typedef decltype(std::abs(value)) Real;
+
+    return std::abs(value) < std::numeric_limits<Real>::epsilon();
+}
+
+template <typename T>
+BlockedLU<T>::BlockedLU(const T *values, size_t n, size_t blockSize, TaskScheduler &scheduler)
+    : m_lu(values, values + n * n), m_pivots(n), m_n(n),
+      m_blockSize(blockSize ? blockSize : DEFAULT_BLOCK_SIZE), m_singular(false),
+      m_scheduler(scheduler)
+{
+    m_blocks = (m_n + m_blockSize - 1) / m_blockSize;
+
+    if (m_blocks <= 1) {
+        factorPanel(0);
+        return;
+    }
+
+    size_t B = m_blocks;
+    TaskGraph graph;
+    std::vector<size_t> panel(B);
+    std::vector<size_t> update(B * B);
+
+    for (size_t k = 0; k < B; k++) {
+        panel[k] = graph.addTask([this, k] { factorPanel(k); });
+
+        for (size_t j = k + 1; j < B; j++) {
+            update[k * B + j] = graph.addTask([this, k, j] { updateBlock(k, j); });
+        }
+    }
+
+    for (size_t k = 0; k < B; k++) {
+        //panel k needs its column block updated by step k-1 only, so it
+        //overlaps with the rest of the trailing update of step k-1
+        if (k > 0) {
+            graph.addDependency(update[(k - 1) * B + k], panel[k]);
+        }
+
+        for (size_t j = k + 1; j < B; j++) {
+            graph.addDependency(panel[k], update[k * B + j]);
+
+            if (k > 0) {
+                graph.addDependency(update[(k - 1) * B + j], update[k * B + j]);
+            }
+        }
+    }
+
+    //last panel transitively depends on every update, L blocks are free now
+    for (size_t j = 0; j + 1 < B; j++) {
+        size_t swap = graph.addTask([this, j] { swapLeft(j); });
+        graph.addDependency(panel[B - 1], swap);
+    }
+
+    m_scheduler.run(graph);
+}
+
+template <typename T>
+void BlockedLU<T>::factorPanel(size_t k)
+{
+    size_t c0 = k * m_blockSize;
+    size_t c1 = std::min(c0 + m_blockSize, m_n);
+    T *a = m_lu.data();
+
+    for (size_t j = c0; j < c1; j++) {
+        size_t p = j;
+        auto best = std::abs(a[j * m_n + j]);
+
+        for (size_t i = j + 1; i < m_n; i++) {
+            auto candidate = std::abs(a[i * m_n + j]);
+
+            if (candidate > best) {
+                best = candidate;
+                p = i;
+            }
+        }
+
+        if (isZeroPivot(a[p * m_n + j])) {
+            m_pivots[j] = j;
+            m_singular = true;
+            continue;
+        }
+
+        m_pivots[j] = p;
+
+        if (p != j) {
+            std::swap_ranges(a + j * m_n + c0, a + j * m_n + c1, a + p * m_n + c0);
+        }
+
+        const T pivot = a[j * m_n + j];
+        const T *pivotRow = a + j * m_n;
+
+        for (size_t i = j + 1; i < m_n; i++) {
+            T *row = a + i * m_n;
+            const T l = row[j] / pivot;
+
+            row[j] = l;
+
+            if (l == T(0)) {
+                continue;
+            }
+
+            for (size_t c = j + 1; c < c1; c++) {
+                row[c] -= l * pivotRow[c];
+            }
+        }
+    }
+}
+
+template <typename T>
+void BlockedLU<T>::updateBlock(size_t k, size_t j)
+{
+    size_t c0 = k * m_blockSize;
+    size_t c1 = std::min(c0 + m_blockSize, m_n);
+    size_t d0 = j * m_blockSize;
+    size_t d1 = std::min(d0 + m_blockSize, m_n);
+    T *a = m_lu.data();
+
+    //row interchanges of panel k
+    for (size_t r = c0; r < c1; r++) {
+        if (m_pivots[r] != r) {
+            std::swap_ranges(a + r * m_n + d0, a + r * m_n + d1, a + m_pivots[r] * m_n + d0);
+        }
+    }
+
+    //U block row: unit lower triangular solve
+    for (size_t r = c0; r < c1; r++) {
+        const T *uRow = a + r * m_n;
+
+        for (size_t i = r + 1; i < c1; i++) {
+            T *row = a + i * m_n;
+            const T l = row[r];
+
+            if (l == T(0)) {
+                continue;
+            }
+
+            for (size_t c = d0; c < d1; c++) {
+                row[c] -= l * uRow[c];
+            }
+        }
+    }
+
+    //trailing update A[c1:, d0:d1] -= L[c1:, c0:c1] * U[c0:c1, d0:d1]
+    for (size_t i = c1; i < m_n; i++) {
+        T *row = a + i * m_n;
+
+        for (size_t r = c0; r < c1; r++) {
+            const T l = row[r];
+            const T *uRow = a + r * m_n;
+
+            if (l == T(0)) {
+                continue;
+            }
+
+            for (size_t c = d0; c < d1; c++) {
+                row[c] -= l * uRow[c];
+            }
+        }
+    }
+}
+
+template <typename T>
+void BlockedLU<T>::swapLeft(size_t j)
+{
+    size_t d0 = j * m_blockSize;
+    size_t d1 = std::min(d0 + m_blockSize, m_n);
+    T *a = m_lu.data();
+
+    for (size_t r = d1; r < m_n; r++) {
+        if (m_pivots[r] != r) {
+            std::swap_ranges(a + r * m_n + d0, a + r * m_n + d1, a + m_pivots[r] * m_n + d0);
+        }
+    }
+}
+
+template <typename T>
+bool BlockedLU<T>::isSingular() const
+{
+    return m_singular;
+}
+
+template <typename T>
+T BlockedLU<T>::determinant() const
+{
+    if (m_singular) {
+        return T(0);
+    }
+
+    T det = T(1);
+
+    for (size_t i = 0; i < m_n; i++) {
+        det *= m_lu[i * m_n + i];
+
+        if (m_pivots[i] != i) {
+            det = -det;
+        }
+    }
+
+    return det;
+}
+
+template <typename T>
+void BlockedLU<T>::solve(T *b) const
+{
+    const T *a = m_lu.data();
+
+    for (size_t i = 0; i < m_n; i++) {
+        if (m_pivots[i] != i) {
+            std::swap(b[i], b[m_pivots[i]]);
+        }
+    }
+
+    for (size_t i = 0; i < m_n; i++) {
+        const T *row = a + i * m_n;
+        T sum = b[i];
+
+        for (size_t j = 0; j < i; j++) {
+            sum -= row[j] * b[j];
+        }
+
+        b[i] = sum;
+    }
+
+    for (size_t i = m_n; i-- > 0;) {
+        const T *row = a + i * m_n;
+        T sum = b[i];
+
+        for (size_t j = i + 1; j < m_n; j++) {
+            sum -= row[j] * b[j];
+        }
+
+        b[i] = sum / row[i];
+    }
+}
+
+template <typename T>
+void BlockedLU<T>::solveColumns(size_t first, size_t last, std::vector<T> &result) const
+{
+    std::vector<T> column(m_n);
+
+    for (size_t c = first; c < last; c++) {
+        std::fill(column.begin(), column.end(), T(0));
+        column[c] = T(1);
+
+        solve(column.data());
+
+        for (size_t i = 0; i < m_n; i++) {
+            result[i * m_n + c] = column[i];
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> BlockedLU<T>::inverse() const
+{
+    std::vector<T> result(m_n * m_n);
+
+    if (m_blocks <= 1) {
+        solveColumns(0, m_n, result);
+        return result;
+    }
+
+    //columns are independent, one task per column block
+    TaskGraph graph;
+
+    for (size_t first = 0; first < m_n; first += m_blockSize) {
+        size_t last = std::min(first + m_blockSize, m_n);
+        graph.addTask([this, first, last, &result] { solveColumns(first, last, result); });
+    }
+
+    m_scheduler.run(graph);
+
+    return result;
+}
+
+template <typename T>
+size_t BlockedLU<T>::size() const
+{
+    return m_n;
+}
+
+template class BlockedLU<float>;
+template class BlockedLU<double>;
+template class BlockedLU<std::complex<double> >;
+
+/*** Konec souboru lu_decomposition.cpp ***/
@@ -0,0 +1,116 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Parallel blocked LU decomposition
+//
+// $NoKeywords: $ivs_project_1 $lu_decomposition.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file lu_decomposition.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace blokove LU dekompozice s castecnou pivotaci.
+ */
+
+#pragma once
+
+#ifndef LU_DECOMPOSITION_H_
+#define LU_DECOMPOSITION_H_
+
+#include <vector>
+
+#include "task_scheduler.h"
+
+/**
+ * @brief The BlockedLU class
+ * Right-looking blokova LU dekompozice PA = LU ctvercove matice ulozene
+ * po radcich. Faktorizace panelu (sloupcoveho bloku) a aktualizace zbytku
+ * matice bezi jako ulohy planovace, faktorizace panelu k+1 tak muze zacit
+ * ihned po aktualizaci sloupcoveho bloku k+1, bez cekani na zbytek matice.
+ *
+ * @tparam T typ prvku (float, double, std::complex<double>)
+ */
+template <typename T>
+class BlockedLU
+{
+public:
+    /**
+     * @brief BlockedLU
+     * Konstruktor, provede dekompozici matice.
+     * @param values    prvky matice n x n ulozene po radcich
+     * @param n         rad matice
+     * @param blockSize sirka sloupcoveho bloku, 0 znamena vychozi sirku
+     * @param scheduler planovac, na kterem bezi ulohy dekompozice
+     */
+    BlockedLU(const T *values, size_t n, size_t blockSize = 0,
+              TaskScheduler &scheduler = TaskScheduler::instance());
+
+    /**
+     * @brief isSingular
+     * @return Vraci true, pokud byl behem dekompozice nalezen nulovy pivot.
+     */
+    bool isSingular() const;
+
+    /**
+     * @brief determinant
+     * @return Vraci determinant puvodni matice.
+     */
+    T determinant() const;
+
+    /**
+     * @brief solve
+     * Vyresi soustavu Ax = b.
+     * @param b prava strana rovnice, po navratu obsahuje reseni x
+     */
+    void solve(T *b) const;
+
+    /**
+     * @brief inverse
+     * Vypocte inverzni matici, sloupce jsou pocitany paralelne.
+     * @return Vraci prvky inverzni matice ulozene po radcich.
+     */
+    std::vector<T> inverse() const;
+
+    /**
+     * @brief size
+     * @return Vraci rad matice.
+     */
+    size_t size() const;
+
+protected:
+    /**
+     * @brief factorPanel
+     * Faktorizuje sloupcovy blok k (radky od diagonaly dolu) s castecnou pivotaci.
+     */
+    void factorPanel(size_t k);
+
+    /**
+     * @brief updateBlock
+     * Aplikuje prohozeni radku panelu k na sloupcovy blok j > k, dopocita blok
+     * radku U a odecte soucin L * U od zbytku sloupcoveho bloku.
+     */
+    void updateBlock(size_t k, size_t j);
+
+    /**
+     * @brief swapLeft
+     * Aplikuje prohozeni radku vsech pozdejsich panelu na sloupcovy blok j (cast L).
+     */
+    void swapLeft(size_t j);
+
+    /**
+     * @brief solveColumns
+     * Vyresi soustavy pro jednotkove sloupce [first, last) inverzni matice.
+     */
+    void solveColumns(size_t first, size_t last, std::vector<T> &result) const;
+
+    std::vector<T> m_lu;                ///< Faktory L (bez diagonaly) a U po radcich.
+    std::vector<size_t> m_pivots;       ///< Radek prohozeny s radkem i v kroku i.
+    size_t m_n;                         ///< Rad matice.
+    size_t m_blockSize;                 ///< Sirka sloupcoveho bloku.
+    size_t m_blocks;                    ///< Pocet sloupcovych bloku.
+    bool m_singular;                    ///< Nalezen nulovy pivot.
+    TaskScheduler &m_scheduler;         ///< Planovac uloh.
+};
+
+#endif // LU_DECOMPOSITION_H_
@@ -0,0 +1,261 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     White Box - matrix benchmarks
+//
+// $NoKeywords: $ivs_project_1 $matrix_bench.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file matrix_bench.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Mereni vykonu operaci nad maticemi (Google Benchmark).
+ *
+ * Kazde mereni hlasi pocet operaci s plovouci carkou za sekundu (FLOPS),
+ * prenesene bajty za sekundu (bytes_per_second) a pocet alokaci na jednu
+ * operaci (allocs).
+ */
+
+#include "benchmark/benchmark.h"
+#include "white_box_code.h"
+#include "alloc_tracker.h"
+
+//============================================================================//
+// Pomocne funkce
+//============================================================================//
+
+/**
+ * Matice s pristupem k chranenemu vypoctu determinantu
+ */
+class BenchMatrix : public Matrix
+{
+public:
+    BenchMatrix(size_t row, size_t col) : Matrix(row, col) {}
+
+    using Matrix::determinant;
+};
+
+/**
+ * Plna, diagonalne dominantni (tedy regularni) matice n x n
+ * @param n rad matice
+ * @return matice
+ */
+static BenchMatrix denseMatrix(size_t n)
+{
+    BenchMatrix mat(n, n);
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            mat(i, j) = double((i * 7 + j * 13) % 17) / 17.0 + 0.1;
+        }
+
+        mat(i, i) += double(n);
+    }
+
+    return mat;
+}
+
+/**
+ * Zapise citace mereni
+ * @param state stav mereni
+ * @param flops pocet operaci s plovouci carkou jedne iterace
+ * @param bytes pocet prenesenych bajtu jedne iterace
+ * @param allocs alokace behem mereni
+ */
+static void report(benchmark::State &state, double flops, double bytes, const AllocTracker &allocs)
+{
+    double iterations = double(state.iterations());
+
+    state.counters["FLOPS"] = benchmark::Counter(flops * iterations, benchmark::Counter::kIsRate);
+    state.counters["allocs"] = benchmark::Counter(double(allocs.allocations()),
+                                                  benchmark::Counter::kAvgIterations);
+    state.SetBytesProcessed(int64_t(bytes * iterations));
+}
+
+//============================================================================//
+// Mereni
+//============================================================================//
+
+static void BM_Construct(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Matrix mat(n, n);
+        benchmark::DoNotOptimize(mat.data());
+    }
+
+    report(state, 0, 8.0 * n * n, allocs);
+}
+
+static void BM_SetGet(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix mat(n, n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        double sum = 0;
+
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                mat.set(i, j, double(i + j));
+                sum += mat.get(i, j);
+            }
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    report(state, double(n) * n, 16.0 * n * n, allocs);
+}
+
+static void BM_Add(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    Matrix b = denseMatrix(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Matrix res = a + b;
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    report(state, double(n) * n, 24.0 * n * n, allocs);
+}
+
+static void BM_MultiplyMatrix(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    Matrix b = denseMatrix(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Matrix res = a * b;
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    report(state, 2.0 * n * n * n, 24.0 * n * n, allocs);
+}
+
+static void BM_MultiplyScalar(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Matrix res = a * 1.5;
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    report(state, double(n) * n, 16.0 * n * n, allocs);
+}
+
+static void BM_MultiplyVector(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    std::vector<double> x(n, 1.0);
+    std::vector<double> y(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        a.multiplyVector(x.data(), y.data());
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    report(state, 2.0 * n * n, 8.0 * (double(n) * n + 2 * n), allocs);
+}
+
+static void BM_MultiplyTransposedVector(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    std::vector<double> x(n, 1.0);
+    std::vector<double> y(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        a.multiplyTransposedVector(x.data(), y.data());
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    report(state, 2.0 * n * n, 8.0 * (double(n) * n + 2 * n), allocs);
+}
+
+static void BM_Transpose(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Matrix res = a.transpose();
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    report(state, 0, 16.0 * n * n, allocs);
+}
+
+static void BM_Determinant(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    BenchMatrix a = denseMatrix(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.determinant());
+    }
+
+    report(state, 2.0 / 3.0 * n * n * n, 8.0 * n * n, allocs);
+}
+
+static void BM_SolveEquation(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    std::vector<double> b(n, 1.0);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        std::vector<double> x = a.solveEquation(b);
+        benchmark::DoNotOptimize(x.data());
+    }
+
+    report(state, 2.0 / 3.0 * n * n * n + 2.0 * n * n, 8.0 * n * n, allocs);
+}
+
+static void BM_Inverse(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    Matrix a = denseMatrix(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Matrix res = a.inverse();
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    report(state, 8.0 / 3.0 * n * n * n, 16.0 * n * n, allocs);
+}
+
+BENCHMARK(BM_Construct)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_SetGet)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_Add)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_MultiplyMatrix)->RangeMultiplier(2)->Range(2, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MultiplyScalar)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_MultiplyVector)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_MultiplyTransposedVector)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_Transpose)->RangeMultiplier(2)->Range(2, 4096);
+BENCHMARK(BM_Determinant)->RangeMultiplier(2)->Range(2, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SolveEquation)->RangeMultiplier(2)->Range(2, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Inverse)->RangeMultiplier(2)->Range(2, 4096)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
+
+/*** Konec souboru matrix_bench.cpp ***/
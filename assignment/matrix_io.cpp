@@ -0,0 +1,380 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Streaming text/CSV matrix loader
+//
+// $NoKeywords: $ivs_project_1 $matrix_io.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file matrix_io.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace nacitani matic z textu.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "matrix_io.h"
+#include "task_scheduler.h"
+
+/**
+ * Velikost bloku cteneho ze souboru
+ */
+static const size_t CHUNK_SIZE = 16 * 1024 * 1024;
+
+/**
+ * @brief The ParsedRows_t struct
+ * Vysledek parsovani useku celych radku.
+ */
+template <typename T>
+struct ParsedRows_t {
+    typename BasicMatrix<T>::Storage_t values;  ///< Prvky useku po radcich.
+    size_t rows;                                ///< Pocet neprazdnych radku.
+    size_t cols;                                ///< Pocet prvku v radku, 0 pro usek bez radku.
+};
+
+/**
+ * @brief isSeparator
+ * @return Vraci true pro oddelovac prvku v radku.
+ */
+static bool isSeparator(char c)
+{
+    return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @brief isDelimiter
+ * @return Vraci true pro oddelovac pole CSV, mezi dvema musi byt hodnota.
+ */
+static bool isDelimiter(char c)
+{
+    return c == ',' || c == ';';
+}
+
+/**
+ * @brief scanRows
+ * Projde usek [begin, end) slozeny z celych radku, zkontroluje pocet prvku
+ * v radcich a prazdna pole a pro kazdy prvek zavola onValue(p, end), ktera
+ * vrati konec prvku.
+ * @param rows Zvysi se o pocet neprazdnych radku.
+ * @param cols Pocet prvku v radku, 0 dokud nebyl nalezen zadny radek.
+ */
+template <typename F>
+static void scanRows(const char *begin, const char *end, size_t &rows, size_t &cols, const F &onValue)
+{
+    const char *p = begin;
+
+    while (p < end) {
+        size_t inRow = 0;
+        bool delimited = false;
+        bool hasValue = false;
+
+        while (p < end && *p != '\n') {
+            if (isDelimiter(*p)) {
+                if (!hasValue) {
+                    throw std::runtime_error("Prazdne pole v textu matice.");
+                }
+
+                delimited = true;
+                hasValue = false;
+                p++;
+                continue;
+            }
+
+            if (isSeparator(*p)) {
+                p++;
+                continue;
+            }
+
+            p = onValue(p, end);
+            hasValue = true;
+            inRow++;
+        }
+
+        //skip new line
+        p++;
+
+        if (delimited && !hasValue) {
+            throw std::runtime_error("Prazdne pole v textu matice.");
+        }
+
+        if (inRow == 0) {
+            continue;
+        }
+
+        if (cols == 0) {
+            cols = inRow;
+        } else if (cols != inRow) {
+            throw std::runtime_error("Radky matice maji ruzny pocet prvku.");
+        }
+
+        rows++;
+    }
+}
+
+/**
+ * @brief parseValue
+ * Precte jeden prvek zacinajici na "p".
+ * @return Vraci konec prvku.
+ */
+template <typename T>
+static const char *parseValue(const char *p, const char *end, T &value)
+{
+    std::from_chars_result res = std::from_chars(p, end, value);
+
+    if (res.ec != std::errc() || (res.ptr < end && !isSeparator(*res.ptr) && *res.ptr != '\n')) {
+        throw std::runtime_error("Neplatne cislo v textu matice.");
+    }
+
+    return res.ptr;
+}
+
+/**
+ * @brief parseRows
+ * Parsuje usek [begin, end) slozeny z celych radku a pripoji prvky do "out".
+ */
+template <typename T>
+static void parseRows(const char *begin, const char *end, ParsedRows_t<T> &out)
+{
+    scanRows(begin, end, out.rows, out.cols, [&out](const char *p, const char *last) {
+        T value;
+        p = parseValue(p, last, value);
+        out.values.push_back(value);
+
+        return p;
+    });
+}
+
+/**
+ * @brief The RowRange_t struct
+ * Usek radku parsovany jednou ulohou planovace.
+ */
+struct RowRange_t {
+    const char *begin;      ///< Zacatek useku.
+    const char *end;        ///< Konec useku (za znakem konce radku).
+    size_t rows;            ///< Pocet neprazdnych radku.
+    size_t cols;            ///< Pocet prvku v radku, 0 pro usek bez radku.
+    size_t offset;          ///< Index prvniho prvku useku ve vysledku.
+};
+
+/**
+ * @brief parseBlock
+ * Parsuje blok celych radku, pri threads > 1 rozdeli blok na useky po radcich.
+ * Useky se nejdrive paralelne spocitaji, pak se "out" zvetsi najednou a kazdy
+ * usek parsuje primo do sveho mista ve vysledku.
+ */
+template <typename T>
+static void parseBlock(const char *begin, const char *end, unsigned threads, ParsedRows_t<T> &out)
+{
+    if (threads == 0) {
+        threads = TaskScheduler::instance().threads();
+    }
+
+    if (threads <= 1 || size_t(end - begin) < 2 * threads) {
+        parseRows(begin, end, out);
+        return;
+    }
+
+    //split on line boundaries
+    std::vector<RowRange_t> ranges(threads);
+    const char *from = begin;
+    size_t step = (end - begin) / threads;
+
+    for (unsigned t = 0; t < threads; t++) {
+        const char *to = end;
+
+        if (t + 1 < threads) {
+            const char *split = std::max(from, begin + (t + 1) * step);
+            const char *newLine = static_cast<const char *>(memchr(split, '\n', end - split));
+
+            to = newLine ? newLine + 1 : end;
+        }
+
+        ranges[t] = RowRange_t{from, to, 0, 0, 0};
+        from = to;
+    }
+
+    //count values of each range, checks the text layout as well
+    TaskGraph counting;
+
+    for (unsigned t = 0; t < threads; t++) {
+        RowRange_t *range = &ranges[t];
+
+        counting.addTask([range] {
+            scanRows(range->begin, range->end, range->rows, range->cols, [](const char *p, const char *last) {
+                while (p < last && !isSeparator(*p) && *p != '\n') {
+                    p++;
+                }
+
+                return p;
+            });
+        });
+    }
+
+    TaskScheduler::instance().run(counting);
+
+    size_t offset = out.values.size();
+
+    for (unsigned t = 0; t < threads; t++) {
+        if (ranges[t].rows == 0) {
+            continue;
+        }
+
+        if (out.cols != 0 && out.cols != ranges[t].cols) {
+            throw std::runtime_error("Radky matice maji ruzny pocet prvku.");
+        }
+
+        out.cols = ranges[t].cols;
+        out.rows += ranges[t].rows;
+        ranges[t].offset = offset;
+        offset += ranges[t].rows * ranges[t].cols;
+    }
+
+    out.values.resize(offset);
+
+    //parse each range into its slice of the result
+    TaskGraph parsing;
+    T *values = out.values.data();
+
+    for (unsigned t = 0; t < threads; t++) {
+        if (ranges[t].rows == 0) {
+            continue;
+        }
+
+        RowRange_t *range = &ranges[t];
+
+        parsing.addTask([range, values] {
+            T *dst = values + range->offset;
+            size_t rows = 0;
+            size_t cols = 0;
+
+            scanRows(range->begin, range->end, rows, cols, [&dst](const char *p, const char *last) {
+                return parseValue(p, last, *dst++);
+            });
+        });
+    }
+
+    TaskScheduler::instance().run(parsing);
+}
+
+/**
+ * @brief toMatrix
+ * Presune nactene prvky do matice.
+ */
+template <typename T>
+static BasicMatrix<T> toMatrix(ParsedRows_t<T> &parsed)
+{
+    if (parsed.rows == 0) {
+        throw std::runtime_error("Text neobsahuje zadnou matici.");
+    }
+
+    return BasicMatrix<T>(parsed.rows, parsed.cols, std::move(parsed.values));
+}
+
+template <typename T>
+BasicMatrix<T> parseMatrixText(const char *text, size_t length, unsigned threads)
+{
+    ParsedRows_t<T> parsed;
+    parsed.rows = 0;
+    parsed.cols = 0;
+
+    parseBlock(text, text + length, threads, parsed);
+
+    return toMatrix(parsed);
+}
+
+template <typename T>
+BasicMatrix<T> loadMatrixText(const char *path, unsigned threads)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        throw std::runtime_error("Soubor s matici nelze otevrit.");
+    }
+
+    long fileSize = -1;
+
+    if (fseek(file, 0, SEEK_END) == 0) {
+        fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+    }
+
+    ParsedRows_t<T> parsed;
+    parsed.rows = 0;
+    parsed.cols = 0;
+
+    std::vector<char> buffer(CHUNK_SIZE);
+    size_t filled = 0;
+    bool reserved = false;
+
+    try {
+        while (true) {
+            if (filled == buffer.size()) {
+                //line longer than whole buffer
+                buffer.resize(buffer.size() * 2);
+            }
+
+            size_t got = fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+            bool eof = got == 0;
+
+            if (eof && ferror(file)) {
+                throw std::runtime_error("Chyba pri cteni souboru s matici.");
+            }
+
+            filled += got;
+
+            //parse only complete lines, the rest moves to the next block
+            size_t complete = filled;
+
+            if (!eof) {
+                while (complete > 0 && buffer[complete - 1] != '\n') {
+                    complete--;
+                }
+
+                if (complete == 0) {
+                    continue;
+                }
+            }
+
+            parseBlock(buffer.data(), buffer.data() + complete, threads, parsed);
+
+            //estimate final size from the first block, so the storage grows only once
+            if (!reserved && fileSize > 0 && complete > 0) {
+                double perByte = double(parsed.values.size()) / complete;
+                parsed.values.reserve(size_t(perByte * fileSize * 1.05) + 1);
+                reserved = true;
+            }
+
+            memmove(buffer.data(), buffer.data() + complete, filled - complete);
+            filled -= complete;
+
+            if (eof) {
+                break;
+            }
+        }
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+
+    fclose(file);
+
+    return toMatrix(parsed);
+}
+
+template BasicMatrix<float> parseMatrixText<float>(const char *, size_t, unsigned);
+template BasicMatrix<double> parseMatrixText<double>(const char *, size_t, unsigned);
+template BasicMatrix<int32_t> parseMatrixText<int32_t>(const char *, size_t, unsigned);
+template BasicMatrix<int64_t> parseMatrixText<int64_t>(const char *, size_t, unsigned);
+
+template BasicMatrix<float> loadMatrixText<float>(const char *, unsigned);
+template BasicMatrix<double> loadMatrixText<double>(const char *, unsigned);
+template BasicMatrix<int32_t> loadMatrixText<int32_t>(const char *, unsigned);
+template BasicMatrix<int64_t> loadMatrixText<int64_t>(const char *, unsigned);
+
+/*** Konec souboru matrix_io.cpp ***/
@@ -0,0 +1,62 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Streaming text/CSV matrix loader
+//
+// $NoKeywords: $ivs_project_1 $matrix_io.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file matrix_io.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace nacitani matic z textu (CSV nebo cisla oddelena mezerami).
+ */
+
+#pragma once
+
+#ifndef MATRIX_IO_H_
+#define MATRIX_IO_H_
+
+#include <cstddef>
+
+#include "white_box_code.h"
+
+/**
+ * @brief      parseMatrixText
+ *      * precte matici z textu v pameti, kazdy neprazdny radek textu je jeden
+ *        radek matice, prvky jsou oddeleny carkou, strednikem, mezerou nebo
+ *        tabulatorem; mezi dvema carkami/stredniky musi byt hodnota
+ *        (prazdne pole CSV je chyba)
+ *
+ * @param      text     text matice
+ * @param      length   delka textu v bajtech
+ * @param      threads  pocet useku radku parsovanych paralelne, 0 znamena
+ *                      pocet vlaken planovace, 1 parsuje sekvencne
+ *
+ * @return     nactena matice
+ *
+ * @throws     std::runtime_error pri neplatnem cisle, prazdnem poli, ruznem
+ *             poctu prvku v radcich nebo prazdnem textu
+ */
+template <typename T>
+BasicMatrix<T> parseMatrixText(const char *text, size_t length, unsigned threads = 1);
+
+/**
+ * @brief      loadMatrixText
+ *      * precte matici ze souboru po blocich pevne velikosti, cisla jsou
+ *        prevadena std::from_chars primo do souvisleho pole prvku matice
+ *        (format viz parseMatrixText)
+ *
+ * @param      path     cesta k souboru
+ * @param      threads  pocet useku radku kazdeho bloku parsovanych paralelne,
+ *                      0 znamena pocet vlaken planovace, 1 parsuje sekvencne
+ *
+ * @return     nactena matice
+ *
+ * @throws     std::runtime_error pokud soubor nelze cist nebo neobsahuje matici
+ */
+template <typename T>
+BasicMatrix<T> loadMatrixText(const char *path, unsigned threads = 1);
+
+#endif // MATRIX_IO_H_
@@ -0,0 +1,215 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Asynchronous batch job queue for matrix operations
+//
+// $NoKeywords: $ivs_project_1 $matrix_jobs.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file matrix_jobs.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace asynchronni fronty uloh nad maticemi.
+ */
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "matrix_jobs.h"
+
+template <typename T>
+BasicMatrixJobQueue<T>::BasicMatrixJobQueue(size_t capacity, size_t maxBatch, TaskScheduler &scheduler)
+    : m_capacity(std::max<size_t>(capacity, 1)), m_maxBatch(std::max<size_t>(maxBatch, 1)),
+      m_scheduler(scheduler), m_active(0), m_stop(false)
+{
+    m_dispatcher = std::thread(&BasicMatrixJobQueue::dispatchLoop, this);
+}
+
+template <typename T>
+BasicMatrixJobQueue<T>::~BasicMatrixJobQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stop = true;
+    }
+
+    m_hasJobs.notify_one();
+    m_dispatcher.join();
+
+    //batches already handed to the scheduler still use this queue
+    wait();
+}
+
+template <typename T>
+std::future<std::vector<T> > BasicMatrixJobQueue<T>::submitSolve(const BasicMatrix<T> &a,
+                                                                 const std::vector<T> &b)
+{
+    JobPtr_t job(new Job_t);
+    job->kind = SOLVE;
+    job->a = a;
+    job->rhs = b;
+
+    std::future<std::vector<T> > result = job->vectorResult.get_future();
+    enqueue(std::move(job));
+
+    return result;
+}
+
+template <typename T>
+std::future<BasicMatrix<T> > BasicMatrixJobQueue<T>::submitInverse(const BasicMatrix<T> &a)
+{
+    JobPtr_t job(new Job_t);
+    job->kind = INVERSE;
+    job->a = a;
+
+    std::future<BasicMatrix<T> > result = job->matrixResult.get_future();
+    enqueue(std::move(job));
+
+    return result;
+}
+
+template <typename T>
+std::future<BasicMatrix<T> > BasicMatrixJobQueue<T>::submitMultiply(const BasicMatrix<T> &a,
+                                                                    const BasicMatrix<T> &b)
+{
+    JobPtr_t job(new Job_t);
+    job->kind = MULTIPLY;
+    job->a = a;
+    job->b = b;
+
+    std::future<BasicMatrix<T> > result = job->matrixResult.get_future();
+    enqueue(std::move(job));
+
+    return result;
+}
+
+template <typename T>
+void BasicMatrixJobQueue<T>::wait()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_hasSpace.wait(lock, [this] { return m_active == 0; });
+}
+
+template <typename T>
+size_t BasicMatrixJobQueue<T>::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    return m_active;
+}
+
+template <typename T>
+void BasicMatrixJobQueue<T>::enqueue(JobPtr_t job)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        //back-pressure, producer waits until a batch finishes
+        m_hasSpace.wait(lock, [this] { return m_active < m_capacity; });
+
+        m_jobs.push_back(std::move(job));
+        m_active++;
+    }
+
+    m_hasJobs.notify_one();
+}
+
+template <typename T>
+void BasicMatrixJobQueue<T>::execute(Job_t &job)
+{
+    try {
+        switch (job.kind) {
+        case SOLVE:
+            job.vectorResult.set_value(job.a.solveEquation(job.rhs));
+            break;
+        case INVERSE:
+            job.matrixResult.set_value(job.a.inverse());
+            break;
+        case MULTIPLY:
+            job.matrixResult.set_value(job.a * job.b);
+            break;
+        }
+    } catch (...) {
+        if (job.kind == SOLVE) {
+            job.vectorResult.set_exception(std::current_exception());
+        } else {
+            job.matrixResult.set_exception(std::current_exception());
+        }
+    }
+}
+
+template <typename T>
+void BasicMatrixJobQueue<T>::finished()
+{
+    //notify under the lock, destructor may return right after m_active drops to 0
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_active--;
+    m_hasSpace.notify_all();
+}
+
+template <typename T>
+void BasicMatrixJobQueue<T>::dispatchLoop()
+{
+    //kind, a rows, a cols, b rows, b cols (b only for MULTIPLY)
+    typedef std::tuple<int, size_t, size_t, size_t, size_t> Key_t;
+    typedef std::shared_ptr<std::vector<JobPtr_t> > Batch_t;
+
+    while (true) {
+        std::vector<Batch_t> batches;
+
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_hasJobs.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+
+            if (m_jobs.empty()) {
+                //stop requested and nothing waiting, running batches are awaited by destructor
+                return;
+            }
+
+            //group by kind and operand sizes, full batches are closed
+            std::map<Key_t, size_t> open;
+
+            while (!m_jobs.empty()) {
+                JobPtr_t job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+
+                bool multiply = job->kind == MULTIPLY;
+                Key_t key(job->kind, job->a.rows(), job->a.cols(),
+                          multiply ? job->b.rows() : 0, multiply ? job->b.cols() : 0);
+                auto it = open.find(key);
+
+                if (it == open.end() || batches[it->second]->size() >= m_maxBatch) {
+                    open[key] = batches.size();
+                    batches.push_back(Batch_t(new std::vector<JobPtr_t>()));
+                    it = open.find(key);
+                }
+
+                batches[it->second]->push_back(std::move(job));
+            }
+        }
+
+        //hand batches over without waiting, new jobs are dispatched while these run
+        for (size_t i = 0; i < batches.size(); i++) {
+            Batch_t batch = batches[i];
+
+            m_scheduler.spawn([this, batch] {
+                for (size_t j = 0; j < batch->size(); j++) {
+                    //execute() catches all exceptions
+                    execute(*(*batch)[j]);
+                    (*batch)[j].reset();
+                    finished();
+                }
+            });
+        }
+    }
+}
+
+template class BasicMatrixJobQueue<float>;
+template class BasicMatrixJobQueue<double>;
+template class BasicMatrixJobQueue<int32_t>;
+template class BasicMatrixJobQueue<int64_t>;
+template class BasicMatrixJobQueue<std::complex<double> >;
+
+/*** Konec souboru matrix_jobs.cpp ***/
@@ -0,0 +1,168 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Asynchronous batch job queue for matrix operations
+//
+// $NoKeywords: $ivs_project_1 $matrix_jobs.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file matrix_jobs.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace asynchronni fronty uloh nad maticemi (reseni soustav,
+ *        inverze, nasobeni) s vysledky pres std::future.
+ */
+
+#pragma once
+
+#ifndef MATRIX_JOBS_H_
+#define MATRIX_JOBS_H_
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "white_box_code.h"
+#include "task_scheduler.h"
+
+/**
+ * @brief The BasicMatrixJobQueue class
+ * Fronta asynchronnich uloh. Dispecerske vlakno odebira cekajici ulohy,
+ * seskupi ulohy stejneho druhu a velikosti operandu do davek (nejvyse
+ * maxBatch uloh) a kazdou davku hned preda planovaci (TaskScheduler::spawn),
+ * na jeji dokonceni neceka. Nove ulohy tak necekaji za nejpomalejsi davkou.
+ * Ulohy davky bezi za sebou na jednom vlakne, pomocne buffery stejne
+ * velikosti tak zustavaji v cache.
+ *
+ * Pri plne fronte (capacity cekajicich a provadenych uloh) submit* blokuje,
+ * dokud se nedokonci nejaka uloha. Vyjimky operaci (napr. singularni matice) jsou
+ * predany pres future.
+ *
+ * @tparam T typ prvku matice
+ */
+template <typename T>
+class BasicMatrixJobQueue
+{
+public:
+    /**
+     * @brief BasicMatrixJobQueue
+     * Konstruktor, spusti dispecerske vlakno.
+     * @param capacity  nejvetsi pocet cekajicich a provadenych uloh
+     * @param maxBatch  nejvetsi pocet uloh v jedne davce
+     * @param scheduler planovac, na kterem se ulohy provadi
+     */
+    explicit BasicMatrixJobQueue(size_t capacity = 256, size_t maxBatch = 16,
+                                 TaskScheduler &scheduler = TaskScheduler::instance());
+
+    /**
+     * @brief ~BasicMatrixJobQueue
+     * Destruktor, provede vsechny prijate ulohy a ukonci dispecerske vlakno.
+     */
+    ~BasicMatrixJobQueue();
+
+    BasicMatrixJobQueue(const BasicMatrixJobQueue &) = delete;
+    BasicMatrixJobQueue &operator=(const BasicMatrixJobQueue &) = delete;
+
+    /**
+     * @brief submitSolve
+     * Zaradi reseni soustavy a * x = b (viz BasicMatrix::solveEquation).
+     * @return Vraci future s resenim x.
+     */
+    std::future<std::vector<T> > submitSolve(const BasicMatrix<T> &a, const std::vector<T> &b);
+
+    /**
+     * @brief submitInverse
+     * Zaradi vypocet inverzni matice (viz BasicMatrix::inverse).
+     * @return Vraci future s inverzni matici.
+     */
+    std::future<BasicMatrix<T> > submitInverse(const BasicMatrix<T> &a);
+
+    /**
+     * @brief submitMultiply
+     * Zaradi soucin matic a * b.
+     * @return Vraci future se soucinem.
+     */
+    std::future<BasicMatrix<T> > submitMultiply(const BasicMatrix<T> &a, const BasicMatrix<T> &b);
+
+    /**
+     * @brief wait
+     * Pocka na dokonceni vsech prijatych uloh.
+     */
+    void wait();
+
+    /**
+     * @brief pending
+     * @return Vraci pocet cekajicich a provadenych uloh.
+     */
+    size_t pending() const;
+
+protected:
+    /**
+     * @brief The Kind_t enum
+     * Druh ulohy.
+     */
+    enum Kind_t {
+        SOLVE,
+        INVERSE,
+        MULTIPLY
+    };
+
+    /**
+     * @brief The Job_t struct
+     * Uloha ve fronte.
+     */
+    struct Job_t {
+        Kind_t kind;                                    ///< Druh ulohy.
+        BasicMatrix<T> a;                               ///< Prvni operand.
+        BasicMatrix<T> b;                               ///< Druhy cinitel (MULTIPLY).
+        std::vector<T> rhs;                             ///< Prava strana (SOLVE).
+        std::promise<std::vector<T> > vectorResult;     ///< Vysledek SOLVE.
+        std::promise<BasicMatrix<T> > matrixResult;     ///< Vysledek INVERSE a MULTIPLY.
+    };
+
+    typedef std::unique_ptr<Job_t> JobPtr_t;
+
+    /**
+     * @brief enqueue
+     * Zaradi ulohu, pri plne fronte ceka na volne misto.
+     */
+    void enqueue(JobPtr_t job);
+
+    /**
+     * @brief execute
+     * Provede ulohu a nastavi jeji vysledek nebo vyjimku.
+     */
+    static void execute(Job_t &job);
+
+    /**
+     * @brief finished
+     * Zapocita dokonceni jedne ulohy.
+     */
+    void finished();
+
+    /**
+     * @brief dispatchLoop
+     * Hlavni smycka dispecerskeho vlakna.
+     */
+    void dispatchLoop();
+
+    size_t m_capacity;                      ///< Nejvetsi pocet uloh ve fronte.
+    size_t m_maxBatch;                      ///< Nejvetsi pocet uloh v davce.
+    TaskScheduler &m_scheduler;             ///< Planovac uloh.
+    std::deque<JobPtr_t> m_jobs;            ///< Cekajici ulohy.
+    size_t m_active;                        ///< Cekajici a provadene ulohy.
+    bool m_stop;                            ///< Pozadavek na ukonceni.
+    mutable std::mutex m_lock;
+    std::condition_variable m_hasJobs;      ///< Probouzeni dispecera.
+    std::condition_variable m_hasSpace;     ///< Uvolneni mista / dokonceni uloh.
+    std::thread m_dispatcher;               ///< Dispecerske vlakno.
+};
+
+typedef BasicMatrixJobQueue<double> MatrixJobQueue;
+
+#endif // MATRIX_JOBS_H_
@@ -0,0 +1,161 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Relaxed concurrent priority queue (MultiQueue)
+//
+// $NoKeywords: $ivs_project_1 $multi_queue.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file multi_queue.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace relaxovane soubezne prioritni fronty.
+ */
+
+#include <stdint.h>
+
+#include <thread>
+
+#include "multi_queue.h"
+#include "instrumentation.h"
+
+const long long MultiQueue::EMPTY;
+
+MultiQueue::MultiQueue(size_t threads, size_t c)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    m_count = threads * (c == 0 ? 1 : c);
+    m_shards.reset(new Shard_t[m_count]);
+
+    for (size_t i = 0; i < m_count; i++) {
+        m_shards[i].top = EMPTY;
+        m_shards[i].size = 0;
+    }
+}
+
+MultiQueue::~MultiQueue()
+{
+}
+
+size_t MultiQueue::random() const
+{
+    static thread_local uint64_t t_state = 0;
+
+    if (t_state == 0) {
+        t_state = reinterpret_cast<uintptr_t>(&t_state) | 1;
+    }
+
+    //xorshift64
+    t_state ^= t_state << 13;
+    t_state ^= t_state >> 7;
+    t_state ^= t_state << 17;
+
+    return (t_state >> 16) % m_count;
+}
+
+void MultiQueue::Insert(int value)
+{
+    IVS_TRACE_SCOPE("MultiQueue::Insert");
+
+    //never wait for a lock, busy shard is replaced by another one
+    while (true) {
+        Shard_t &shard = m_shards[random()];
+        std::unique_lock<std::mutex> lock(shard.lock, std::try_to_lock);
+
+        if (!lock.owns_lock()) {
+            IVS_TRACE_STEPS(1);
+            continue;
+        }
+
+        shard.heap.Insert(value);
+        shard.top.store(shard.heap.GetHead()->value, std::memory_order_relaxed);
+        shard.size.fetch_add(1, std::memory_order_relaxed);
+
+        return;
+    }
+}
+
+bool MultiQueue::popLocked(Shard_t &shard, int *pValue)
+{
+    if (!shard.heap.PopTop(pValue)) {
+        return false;
+    }
+
+    HeapPriorityQueue::Element_t *head = shard.heap.GetHead();
+
+    shard.top.store(head != NULL ? head->value : EMPTY, std::memory_order_relaxed);
+    shard.size.fetch_sub(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool MultiQueue::PopTop(int *pValue)
+{
+    IVS_TRACE_SCOPE("MultiQueue::PopTop");
+
+    //two random choices, give up after a number of empty picks
+    for (size_t attempt = 0; attempt < 2 * m_count; attempt++) {
+        Shard_t &first = m_shards[random()];
+        Shard_t &second = m_shards[random()];
+        long long firstTop = first.top.load(std::memory_order_relaxed);
+        long long secondTop = second.top.load(std::memory_order_relaxed);
+
+        Shard_t &shard = firstTop >= secondTop ? first : second;
+
+        if (firstTop == EMPTY && secondTop == EMPTY) {
+            IVS_TRACE_STEPS(1);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(shard.lock, std::try_to_lock);
+
+        if (lock.owns_lock() && popLocked(shard, pValue)) {
+            return true;
+        }
+
+        IVS_TRACE_STEPS(1);
+    }
+
+    //queue looks empty, check every shard before reporting it
+    for (size_t i = 0; i < m_count; i++) {
+        std::lock_guard<std::mutex> lock(m_shards[i].lock);
+
+        if (popLocked(m_shards[i], pValue)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t MultiQueue::PopTop(size_t k, int *pOut)
+{
+    size_t count = 0;
+
+    while (count < k && PopTop(pOut != NULL ? &pOut[count] : NULL)) {
+        count++;
+    }
+
+    return count;
+}
+
+size_t MultiQueue::Length() const
+{
+    size_t length = 0;
+
+    for (size_t i = 0; i < m_count; i++) {
+        length += m_shards[i].size.load(std::memory_order_relaxed);
+    }
+
+    return length;
+}
+
+/*** Konec souboru multi_queue.cpp ***/
@@ -0,0 +1,130 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Relaxed concurrent priority queue (MultiQueue)
+//
+// $NoKeywords: $ivs_project_1 $multi_queue.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file multi_queue.h
+ * @author Lukáš Plevač
+ *
+ * @brief Definice relaxovane soubezne prioritni fronty rozdelene do vice
+ *        samostatne zamykanych hald.
+ */
+
+#pragma once
+
+#ifndef MULTI_QUEUE_H_
+#define MULTI_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "heap_priority_queue.h"
+
+/**
+ * @brief The MultiQueue class
+ * Relaxovana prioritni fronta pro mnoho vlaken (MultiQueue). Polozky jsou
+ * rozdeleny do c * P hald (P vlaken), kazda halda ma vlastni zamek. Insert
+ * vlozi polozku do nahodne haldy, PopTop porovna vrcholy dvou nahodnych hald
+ * a odebere vetsi z nich. Zadne vlakno neceka na zamek, obsazena halda se
+ * preskoci a zvoli se jina.
+ *
+ * Odebrana polozka nemusi byt globalne nejvetsi. Pro n = c * P hald je
+ * ocekavany rank odebrane polozky (pocet vetsich polozek ve fronte) O(n) a
+ * s vysokou pravdepodobnosti O(n log n) nezavisle na delce fronty (Rihani,
+ * Sanders, Dementiev: MultiQueues, SPAA 2015). S jednou haldou je poradi presne.
+ * Pri prazdne fronte PopTop projde vsechny haldy, false tedy znamena, ze
+ * behem volani byly vsechny haldy prazdne.
+ */
+class MultiQueue
+{
+public:
+    /**
+     * @brief MultiQueue
+     * Konstruktor, vytvori prazdnou frontu s c * threads haldami.
+     * @param threads Ocekavany pocet soubeznych vlaken (0 = pocet jader).
+     * @param c Pocet hald na vlakno.
+     */
+    explicit MultiQueue(size_t threads = 0, size_t c = 2);
+
+    /**
+     * @brief ~MultiQueue
+     * Destruktor, odstrani vsechny polozky.
+     */
+    ~MultiQueue();
+
+    MultiQueue(const MultiQueue &) = delete;
+    MultiQueue &operator=(const MultiQueue &) = delete;
+
+    /**
+     * @brief Insert
+     * Zaradi novou polozku s hodnotou "value" do nahodne haldy.
+     */
+    void Insert(int value);
+
+    /**
+     * @brief PopTop
+     * Odebere polozku s priblizne nejvetsi hodnotou (viz popis tridy).
+     * @param pValue Pokud neni NULL, zapise se sem hodnota odebrane polozky.
+     * @return Vrati false, pokud je fronta prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" polozek, kazdou samostatnym PopTop.
+     * @param pOut Pole pro alespon "k" hodnot, nebo NULL.
+     * @return Vrati pocet odebranych polozek.
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief Length
+     * @return Vrati pocet polozek (pri soubeznych zmenach priblizne).
+     */
+    size_t Length() const;
+
+    /**
+     * @brief Shards
+     * @return Vrati pocet hald.
+     */
+    size_t Shards() const { return m_count; }
+
+protected:
+    /**
+     * @brief The Shard_t struct
+     * Halda se zamkem, kazda na vlastnich radcich cache.
+     */
+    struct alignas(64) Shard_t {
+        std::mutex lock;
+        HeapPriorityQueue heap;
+        std::atomic<long long> top;         ///< Vrchol haldy pro cteni bez zamku (EMPTY pro prazdnou).
+        std::atomic<size_t> size;           ///< Pocet polozek haldy.
+    };
+
+    /**
+     * Hodnota "top" prazdne haldy, mensi nez kazda hodnota int
+     */
+    static const long long EMPTY = -(1LL << 62);
+
+    /**
+     * @brief random
+     * @return Vrati nahodny index haldy (xorshift ve vlakne).
+     */
+    size_t random() const;
+
+    /**
+     * @brief popLocked
+     * Odebere vrchol zamcene haldy a aktualizuje jeji vrchol a velikost.
+     */
+    static bool popLocked(Shard_t &shard, int *pValue);
+
+    std::unique_ptr<Shard_t[]> m_shards;    ///< Haldy.
+    size_t m_count;                         ///< Pocet hald.
+};
+
+#endif // MULTI_QUEUE_H_
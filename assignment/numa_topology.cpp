@@ -0,0 +1,174 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     NUMA topology detection and thread pinning
+//
+// $NoKeywords: $ivs_project_1 $numa_topology.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file numa_topology.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace zjisteni NUMA uzlu a pripinani vlaken.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+#include "numa_topology.h"
+
+#ifdef __linux__
+/**
+ * @brief readCpuList
+ * @return Vraci procesory uzlu podle /sys/devices/system/node/node<N>/cpulist.
+ */
+static std::vector<unsigned> readCpuList(unsigned node)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return std::vector<unsigned>();
+    }
+
+    std::string list;
+    char buffer[256];
+
+    while (fgets(buffer, sizeof(buffer), file) != NULL) {
+        list += buffer;
+    }
+
+    fclose(file);
+
+    return NumaTopology::parseCpuList(list);
+}
+#endif
+
+NumaTopology::NumaTopology()
+{
+#ifdef __linux__
+    DIR *dir = opendir("/sys/devices/system/node");
+
+    if (dir != NULL) {
+        std::vector<unsigned> ids;
+
+        while (struct dirent *entry = readdir(dir)) {
+            unsigned id;
+            char rest;
+
+            if (sscanf(entry->d_name, "node%u%c", &id, &rest) == 1) {
+                ids.push_back(id);
+            }
+        }
+
+        closedir(dir);
+        std::sort(ids.begin(), ids.end());
+
+        //memory only nodes have no cpus
+        for (size_t i = 0; i < ids.size(); i++) {
+            std::vector<unsigned> cpus = readCpuList(ids[i]);
+
+            if (!cpus.empty()) {
+                m_nodeCpus.push_back(cpus);
+            }
+        }
+    }
+#endif
+
+    if (m_nodeCpus.empty()) {
+        unsigned count = std::max(1u, std::thread::hardware_concurrency());
+        m_nodeCpus.push_back(std::vector<unsigned>());
+
+        for (unsigned cpu = 0; cpu < count; cpu++) {
+            m_nodeCpus[0].push_back(cpu);
+        }
+    }
+}
+
+const NumaTopology &NumaTopology::instance()
+{
+    static NumaTopology topology;
+
+    return topology;
+}
+
+size_t NumaTopology::nodes() const
+{
+    return m_nodeCpus.size();
+}
+
+const std::vector<unsigned> &NumaTopology::cpus(size_t node) const
+{
+    return m_nodeCpus[node];
+}
+
+size_t NumaTopology::nodeOf(size_t index, size_t count) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    return std::min(index, count - 1) * m_nodeCpus.size() / count;
+}
+
+std::vector<unsigned> NumaTopology::parseCpuList(const std::string &list)
+{
+    std::vector<unsigned> cpus;
+    const char *p = list.c_str();
+
+    while (*p != '\0') {
+        char *end;
+        unsigned long first = strtoul(p, &end, 10);
+
+        if (end == p) {
+            //separator or trailing new line
+            p++;
+            continue;
+        }
+
+        unsigned long last = first;
+        p = end;
+
+        if (*p == '-') {
+            last = strtoul(p + 1, &end, 10);
+            p = end;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(unsigned(cpu));
+        }
+    }
+
+    return cpus;
+}
+
+bool NumaTopology::pinCurrentThread(const std::vector<unsigned> &cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE) {
+            CPU_SET(cpus[i], &set);
+        }
+    }
+
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+/*** Konec souboru numa_topology.cpp ***/
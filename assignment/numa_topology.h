@@ -0,0 +1,81 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     NUMA topology detection and thread pinning
+//
+// $NoKeywords: $ivs_project_1 $numa_topology.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file numa_topology.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace zjisteni NUMA uzlu (Linux sysfs) a pripinani vlaken.
+ */
+
+#pragma once
+
+#ifndef NUMA_TOPOLOGY_H_
+#define NUMA_TOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The NumaTopology class
+ * Seznam NUMA uzlu a jejich procesoru. Na systemech bez NUMA (nebo mimo
+ * Linux) obsahuje jediny uzel se vsemi procesory.
+ */
+class NumaTopology
+{
+public:
+    /**
+     * @brief NumaTopology
+     * Konstruktor, nacte uzly z /sys/devices/system/node.
+     */
+    NumaTopology();
+
+    /**
+     * @brief instance
+     * @return Vraci topologii systemu (nactenou pri prvnim volani).
+     */
+    static const NumaTopology &instance();
+
+    /**
+     * @brief nodes
+     * @return Vraci pocet NUMA uzlu s alespon jednim procesorem.
+     */
+    size_t nodes() const;
+
+    /**
+     * @brief cpus
+     * @return Vraci procesory uzlu "node".
+     */
+    const std::vector<unsigned> &cpus(size_t node) const;
+
+    /**
+     * @brief nodeOf
+     * Rozdeli "count" vlaken (nebo bloku prace) souvisle mezi uzly.
+     * @return Vraci uzel vlakna "index".
+     */
+    size_t nodeOf(size_t index, size_t count) const;
+
+    /**
+     * @brief parseCpuList
+     * Prevede seznam procesoru ve formatu sysfs (napr. "0-3,8,10-11").
+     * @return Vraci cisla procesoru.
+     */
+    static std::vector<unsigned> parseCpuList(const std::string &list);
+
+    /**
+     * @brief pinCurrentThread
+     * Omezi beh aktualniho vlakna na dane procesory.
+     * @return Vraci false, pokud pripnuti neni podporovano nebo selhalo.
+     */
+    static bool pinCurrentThread(const std::vector<unsigned> &cpus);
+
+protected:
+    std::vector<std::vector<unsigned> > m_nodeCpus;     ///< Procesory jednotlivych uzlu.
+};
+
+#endif // NUMA_TOPOLOGY_H_
@@ -0,0 +1,673 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Packed triangular, symmetric and banded matrices
+//
+// $NoKeywords: $ivs_project_1 $packed_matrix.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file packed_matrix.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace matic s kompaktnim ulozenim.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "packed_matrix.h"
+
+/**
+ * @brief checkVector
+ * Zkontroluje, ze vektor ma n prvku.
+ */
+template <typename T>
+static void checkVector(const std::vector<T> &x, size_t n)
+{
+    if(x.size() != n)
+        throw std::runtime_error("Pocet prvku vektoru musi odpovidat radu matice.");
+}
+
+/**
+ * @brief checkOrder
+ * Zkontroluje rad nove matice.
+ */
+static void checkOrder(size_t n)
+{
+    if(n < 1)
+        throw std::runtime_error("Minimalni velikost matice je 1x1");
+}
+
+/**
+ * @brief fromWorkVector
+ * @return Vraci vektor prevedeny z pracovniho typu na typ prvku.
+ */
+template <typename T>
+static std::vector<T> fromWorkVector(const std::vector<typename MatrixTraits<T>::WorkType> &x)
+{
+    std::vector<T> res(x.size());
+
+    for(size_t i = 0; i < x.size(); i++)
+        res[i] = MatrixTraits<T>::fromWork(x[i]);
+
+    return res;
+}
+
+//============================================================================//
+// TriangularMatrix
+//============================================================================//
+
+template <typename T>
+TriangularMatrix<T>::TriangularMatrix(size_t n, Triangle_t triangle)
+    : m_n(n), m_triangle(triangle)
+{
+    checkOrder(n);
+
+    m_values.assign(n * (n + 1) / 2, T(0));
+}
+
+template <typename T>
+TriangularMatrix<T> TriangularMatrix<T>::fromMatrix(const BasicMatrix<T> &m, Triangle_t triangle)
+{
+    if(m.rows() != m.cols())
+        throw std::runtime_error("Matice musi byt ctvercova.");
+
+    TriangularMatrix result(m.rows(), triangle);
+
+    for(size_t r = 0; r < m.rows(); r++)
+    {
+        for(size_t c = 0; c < m.cols(); c++)
+        {
+            if(result.contains(r, c))
+                result.m_values[result.index(r, c)] = m(r, c);
+            else if(m(r, c) != T(0))
+                throw std::runtime_error("Matice neni trojuhelnikova.");
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> TriangularMatrix<T>::toMatrix() const
+{
+    BasicMatrix<T> result(m_n, m_n);
+
+    for(size_t r = 0; r < m_n; r++)
+    {
+        size_t first = m_triangle == UPPER ? r : 0;
+        size_t last = m_triangle == UPPER ? m_n : r + 1;
+
+        std::copy(&m_values[index(r, first)], &m_values[index(r, first)] + (last - first), result.row(r) + first);
+    }
+
+    return result;
+}
+
+template <typename T>
+size_t TriangularMatrix<T>::index(size_t row, size_t col) const
+{
+    if(m_triangle == LOWER)
+        return row * (row + 1) / 2 + col;
+
+    // radek r zacina za r predchozimi radky delky n, n - 1, ...
+    return row * (2 * m_n - row + 1) / 2 + (col - row);
+}
+
+template <typename T>
+bool TriangularMatrix<T>::contains(size_t row, size_t col) const
+{
+    return m_triangle == UPPER ? col >= row : col <= row;
+}
+
+template <typename T>
+T TriangularMatrix<T>::get(size_t row, size_t col) const
+{
+    if(row >= m_n || col >= m_n)
+        throw std::runtime_error("Index je mimo matici.");
+
+    return contains(row, col) ? m_values[index(row, col)] : T(0);
+}
+
+template <typename T>
+void TriangularMatrix<T>::set(size_t row, size_t col, T value)
+{
+    if(row >= m_n || col >= m_n || !contains(row, col))
+        throw std::runtime_error("Prvek lezi mimo ulozeny trojuhelnik.");
+
+    m_values[index(row, col)] = value;
+}
+
+template <typename T>
+std::vector<T> TriangularMatrix<T>::multiply(const std::vector<T> &x) const
+{
+    checkVector(x, m_n);
+
+    std::vector<T> y(m_n, T(0));
+
+    for(size_t r = 0; r < m_n; r++)
+    {
+        size_t first = m_triangle == UPPER ? r : 0;
+        size_t last = m_triangle == UPPER ? m_n : r + 1;
+        const T *values = &m_values[index(r, first)];
+        T sum = T(0);
+
+        for(size_t c = first; c < last; c++)
+            sum += values[c - first] * x[c];
+
+        y[r] = sum;
+    }
+
+    return y;
+}
+
+template <typename T>
+std::vector<T> TriangularMatrix<T>::solve(const std::vector<T> &b) const
+{
+    typedef typename MatrixTraits<T>::WorkType W;
+
+    checkVector(b, m_n);
+
+    std::vector<W> x(b.begin(), b.end());
+
+    for(size_t k = 0; k < m_n; k++)
+    {
+        // horni trojuhelnik zpetne od posledniho radku
+        size_t r = m_triangle == UPPER ? m_n - 1 - k : k;
+        size_t first = m_triangle == UPPER ? r : 0;
+        size_t last = m_triangle == UPPER ? m_n : r + 1;
+        const T *values = &m_values[index(r, first)];
+        W diag = W(values[r - first]);
+
+        if(MatrixTraits<W>::isZero(diag))
+            throw std::runtime_error("Matice je singularni.");
+
+        W sum = x[r];
+
+        for(size_t c = first; c < last; c++)
+        {
+            if(c != r)
+                sum -= W(values[c - first]) * x[c];
+        }
+
+        x[r] = sum / diag;
+    }
+
+    return fromWorkVector<T>(x);
+}
+
+//============================================================================//
+// SymmetricMatrix
+//============================================================================//
+
+template <typename T>
+SymmetricMatrix<T>::SymmetricMatrix(size_t n)
+    : m_n(n)
+{
+    checkOrder(n);
+
+    m_values.assign(n * (n + 1) / 2, T(0));
+}
+
+template <typename T>
+SymmetricMatrix<T> SymmetricMatrix<T>::fromMatrix(const BasicMatrix<T> &m)
+{
+    if(m.rows() != m.cols())
+        throw std::runtime_error("Matice musi byt ctvercova.");
+
+    SymmetricMatrix result(m.rows());
+
+    for(size_t r = 0; r < m.rows(); r++)
+    {
+        for(size_t c = 0; c <= r; c++)
+        {
+            if(m(r, c) != m(c, r))
+                throw std::runtime_error("Matice neni symetricka.");
+
+            result.m_values[index(r, c)] = m(r, c);
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> SymmetricMatrix<T>::toMatrix() const
+{
+    BasicMatrix<T> result(m_n, m_n);
+
+    for(size_t r = 0; r < m_n; r++)
+    {
+        for(size_t c = 0; c <= r; c++)
+        {
+            result(r, c) = m_values[index(r, c)];
+            result(c, r) = m_values[index(r, c)];
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+T SymmetricMatrix<T>::get(size_t row, size_t col) const
+{
+    if(row >= m_n || col >= m_n)
+        throw std::runtime_error("Index je mimo matici.");
+
+    return row >= col ? m_values[index(row, col)] : m_values[index(col, row)];
+}
+
+template <typename T>
+void SymmetricMatrix<T>::set(size_t row, size_t col, T value)
+{
+    if(row >= m_n || col >= m_n)
+        throw std::runtime_error("Index je mimo matici.");
+
+    m_values[row >= col ? index(row, col) : index(col, row)] = value;
+}
+
+template <typename T>
+std::vector<T> SymmetricMatrix<T>::multiply(const std::vector<T> &x) const
+{
+    checkVector(x, m_n);
+
+    std::vector<T> y(m_n, T(0));
+
+    // prvek (r, c) pod diagonalou prispiva do y[r] i y[c]
+    for(size_t r = 0; r < m_n; r++)
+    {
+        const T *values = &m_values[index(r, 0)];
+        T sum = T(0);
+
+        for(size_t c = 0; c < r; c++)
+        {
+            sum += values[c] * x[c];
+            y[c] += values[c] * x[r];
+        }
+
+        y[r] += sum + values[r] * x[r];
+    }
+
+    return y;
+}
+
+template <typename T>
+std::vector<T> SymmetricMatrix<T>::solve(const std::vector<T> &b) const
+{
+    typedef typename MatrixTraits<T>::WorkType W;
+    typedef decltype(std::abs(W())) R;
+
+    checkVector(b, m_n);
+
+    // Bunch-Kaufman: P * A * P^T = L * D * L^T, D ma bloky 1x1 a 2x2,
+    // L a D se ukladaji na misto dolniho trojuhelniku
+    const R alpha = (R(1) + std::sqrt(R(17))) / R(8);
+
+    std::vector<W> a(m_values.begin(), m_values.end());
+    std::vector<size_t> pivot(m_n);
+    std::vector<unsigned char> step(m_n, 0);
+
+    auto at = [&a](size_t row, size_t col) -> W & {
+        return a[index(row, col)];
+    };
+
+    for(size_t k = 0; k < m_n;)
+    {
+        R diagMax = std::abs(at(k, k));
+        R colMax = 0;
+        size_t colArg = k;
+
+        for(size_t i = k + 1; i < m_n; i++)
+        {
+            if(std::abs(at(i, k)) > colMax)
+            {
+                colMax = std::abs(at(i, k));
+                colArg = i;
+            }
+        }
+
+        if(MatrixTraits<W>::isZero(W(std::max(diagMax, colMax))))
+            throw std::runtime_error("Matice je singularni.");
+
+        size_t kp = k;
+        size_t kstep = 1;
+
+        if(diagMax < alpha * colMax)
+        {
+            // nejvetsi prvek mimo diagonalu v radku a sloupci colArg
+            R rowMax = 0;
+
+            for(size_t j = k; j < colArg; j++)
+                rowMax = std::max(rowMax, R(std::abs(at(colArg, j))));
+            for(size_t i = colArg + 1; i < m_n; i++)
+                rowMax = std::max(rowMax, R(std::abs(at(i, colArg))));
+
+            if(diagMax * rowMax >= alpha * colMax * colMax)
+                kp = k;
+            else if(std::abs(at(colArg, colArg)) >= alpha * rowMax)
+                kp = colArg;
+            else
+            {
+                kp = colArg;
+                kstep = 2;
+            }
+        }
+
+        // symetricka zamena radku a sloupcu kk a kp ve zbytku matice
+        size_t kk = k + kstep - 1;
+
+        if(kp != kk)
+        {
+            for(size_t i = kp + 1; i < m_n; i++)
+                std::swap(at(i, kk), at(i, kp));
+            for(size_t j = kk + 1; j < kp; j++)
+                std::swap(at(j, kk), at(kp, j));
+
+            std::swap(at(kk, kk), at(kp, kp));
+
+            if(kstep == 2)
+                std::swap(at(k + 1, k), at(kp, k));
+        }
+
+        pivot[k] = kp;
+        step[k] = (unsigned char)kstep;
+
+        if(kstep == 1)
+        {
+            W r = W(1) / at(k, k);
+
+            for(size_t j = k + 1; j < m_n; j++)
+            {
+                W w = at(j, k) * r;
+
+                for(size_t i = j; i < m_n; i++)
+                    at(i, j) -= at(i, k) * w;
+
+                at(j, k) = w;
+            }
+        }
+        else
+        {
+            // inverze bloku D skalovana mimodiagonalnim prvkem (jako LAPACK)
+            W d21 = at(k + 1, k);
+            W d11 = at(k + 1, k + 1) / d21;
+            W d22 = at(k, k) / d21;
+            W t = W(1) / (d11 * d22 - W(1));
+
+            d21 = t / d21;
+
+            for(size_t j = k + 2; j < m_n; j++)
+            {
+                W wk = d21 * (d11 * at(j, k) - at(j, k + 1));
+                W wk1 = d21 * (d22 * at(j, k + 1) - at(j, k));
+
+                for(size_t i = j; i < m_n; i++)
+                    at(i, j) -= at(i, k) * wk + at(i, k + 1) * wk1;
+
+                at(j, k) = wk;
+                at(j, k + 1) = wk1;
+            }
+        }
+
+        k += kstep;
+    }
+
+    std::vector<W> x(b.begin(), b.end());
+
+    // P * L * D * z = b
+    for(size_t k = 0; k < m_n;)
+    {
+        if(step[k] == 1)
+        {
+            std::swap(x[k], x[pivot[k]]);
+
+            for(size_t i = k + 1; i < m_n; i++)
+                x[i] -= at(i, k) * x[k];
+
+            x[k] /= at(k, k);
+            k++;
+        }
+        else
+        {
+            std::swap(x[k + 1], x[pivot[k]]);
+
+            for(size_t i = k + 2; i < m_n; i++)
+                x[i] -= at(i, k) * x[k] + at(i, k + 1) * x[k + 1];
+
+            W d21 = at(k + 1, k);
+            W d11 = at(k, k) / d21;
+            W d22 = at(k + 1, k + 1) / d21;
+            W denom = d11 * d22 - W(1);
+            W b1 = x[k] / d21;
+            W b2 = x[k + 1] / d21;
+
+            x[k] = (d22 * b1 - b2) / denom;
+            x[k + 1] = (d11 * b2 - b1) / denom;
+            k += 2;
+        }
+    }
+
+    // L^T * P^T * x = z, bloky odzadu
+    for(size_t k = m_n; k-- > 0;)
+    {
+        size_t first = (k > 0 && step[k] == 0) ? k - 1 : k;
+
+        for(size_t c = first; c <= k; c++)
+        {
+            for(size_t i = k + 1; i < m_n; i++)
+                x[c] -= at(i, c) * x[i];
+        }
+
+        std::swap(x[k], x[pivot[first]]);
+        k = first;
+    }
+
+    return fromWorkVector<T>(x);
+}
+
+//============================================================================//
+// BandedMatrix
+//============================================================================//
+
+template <typename T>
+BandedMatrix<T>::BandedMatrix(size_t n, size_t kl, size_t ku)
+    : m_n(n), m_kl(std::min(kl, n - 1)), m_ku(std::min(ku, n - 1))
+{
+    checkOrder(n);
+
+    m_values.assign(n * (m_kl + m_ku + 1), T(0));
+}
+
+template <typename T>
+BandedMatrix<T> BandedMatrix<T>::fromMatrix(const BasicMatrix<T> &m)
+{
+    if(m.rows() != m.cols())
+        throw std::runtime_error("Matice musi byt ctvercova.");
+
+    return fromMatrix(m, m.lowerBandwidth(), m.upperBandwidth());
+}
+
+template <typename T>
+BandedMatrix<T> BandedMatrix<T>::fromMatrix(const BasicMatrix<T> &m, size_t kl, size_t ku)
+{
+    if(m.rows() != m.cols())
+        throw std::runtime_error("Matice musi byt ctvercova.");
+
+    BandedMatrix result(m.rows(), kl, ku);
+
+    for(size_t r = 0; r < m.rows(); r++)
+    {
+        for(size_t c = 0; c < m.cols(); c++)
+        {
+            if(result.contains(r, c))
+                result.set(r, c, m(r, c));
+            else if(m(r, c) != T(0))
+                throw std::runtime_error("Prvek lezi mimo pas matice.");
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BandedMatrix<T>::toMatrix() const
+{
+    BasicMatrix<T> result(m_n, m_n);
+    size_t width = m_kl + m_ku + 1;
+
+    for(size_t r = 0; r < m_n; r++)
+    {
+        size_t first = r > m_kl ? r - m_kl : 0;
+        size_t last = std::min(m_n - 1, r + m_ku);
+
+        for(size_t c = first; c <= last; c++)
+            result(r, c) = m_values[r * width + c + m_kl - r];
+    }
+
+    return result;
+}
+
+template <typename T>
+T BandedMatrix<T>::get(size_t row, size_t col) const
+{
+    if(row >= m_n || col >= m_n)
+        throw std::runtime_error("Index je mimo matici.");
+
+    if(!contains(row, col))
+        return T(0);
+
+    return m_values[row * (m_kl + m_ku + 1) + col + m_kl - row];
+}
+
+template <typename T>
+void BandedMatrix<T>::set(size_t row, size_t col, T value)
+{
+    if(row >= m_n || col >= m_n || !contains(row, col))
+        throw std::runtime_error("Prvek lezi mimo pas matice.");
+
+    m_values[row * (m_kl + m_ku + 1) + col + m_kl - row] = value;
+}
+
+template <typename T>
+std::vector<T> BandedMatrix<T>::multiply(const std::vector<T> &x) const
+{
+    checkVector(x, m_n);
+
+    std::vector<T> y(m_n);
+    size_t width = m_kl + m_ku + 1;
+
+    for(size_t r = 0; r < m_n; r++)
+    {
+        size_t first = r > m_kl ? r - m_kl : 0;
+        size_t last = std::min(m_n - 1, r + m_ku);
+        const T *values = &m_values[r * width + m_kl - r];
+        T sum = T(0);
+
+        for(size_t c = first; c <= last; c++)
+            sum += values[c] * x[c];
+
+        y[r] = sum;
+    }
+
+    return y;
+}
+
+template <typename T>
+std::vector<T> BandedMatrix<T>::solve(const std::vector<T> &b) const
+{
+    typedef typename MatrixTraits<T>::WorkType W;
+
+    checkVector(b, m_n);
+
+    // prohozeni radku rozsiri horni pas na kl + ku, radek i pracovni kopie
+    // uklada sloupce i - kl .. i + kl + ku
+    size_t n = m_n;
+    size_t kl = m_kl;
+    size_t upper = m_kl + m_ku;
+    size_t width = kl + upper + 1;
+    size_t srcWidth = m_kl + m_ku + 1;
+    std::vector<W> lu(n * width, W(0));
+    std::vector<W> x(b.begin(), b.end());
+
+    for(size_t r = 0; r < n; r++)
+        std::copy(&m_values[r * srcWidth], &m_values[r * srcWidth] + srcWidth, &lu[r * width]);
+
+    // prvek (r, c) pracovni kopie
+    auto at = [&lu, width, kl](size_t r, size_t c) -> W & {
+        return lu[r * width + c + kl - r];
+    };
+
+    for(size_t j = 0; j < n; j++)
+    {
+        size_t last = std::min(n - 1, j + kl);
+        size_t colLast = std::min(n - 1, j + upper);
+        size_t p = j;
+
+        for(size_t i = j + 1; i <= last; i++)
+        {
+            if(std::abs(at(i, j)) > std::abs(at(p, j)))
+                p = i;
+        }
+
+        if(MatrixTraits<W>::isZero(at(p, j)))
+            throw std::runtime_error("Matice je singularni.");
+
+        if(p != j)
+        {
+            for(size_t c = j; c <= colLast; c++)
+                std::swap(at(j, c), at(p, c));
+
+            std::swap(x[j], x[p]);
+        }
+
+        const W pivot = at(j, j);
+
+        for(size_t i = j + 1; i <= last; i++)
+        {
+            W l = at(i, j) / pivot;
+
+            if(l == W(0))
+                continue;
+
+            for(size_t c = j + 1; c <= colLast; c++)
+                at(i, c) -= l * at(j, c);
+
+            x[i] -= l * x[j];
+        }
+    }
+
+    for(size_t i = n; i-- > 0;)
+    {
+        W sum = x[i];
+        size_t last = std::min(n - 1, i + upper);
+
+        for(size_t c = i + 1; c <= last; c++)
+            sum -= at(i, c) * x[c];
+
+        x[i] = sum / at(i, i);
+    }
+
+    return fromWorkVector<T>(x);
+}
+
+template class TriangularMatrix<float>;
+template class TriangularMatrix<double>;
+template class TriangularMatrix<int32_t>;
+template class TriangularMatrix<int64_t>;
+template class TriangularMatrix<std::complex<double> >;
+
+template class SymmetricMatrix<float>;
+template class SymmetricMatrix<double>;
+template class SymmetricMatrix<int32_t>;
+template class SymmetricMatrix<int64_t>;
+template class SymmetricMatrix<std::complex<double> >;
+
+template class BandedMatrix<float>;
+template class BandedMatrix<double>;
+template class BandedMatrix<int32_t>;
+template class BandedMatrix<int64_t>;
+template class BandedMatrix<std::complex<double> >;
+
+/*** Konec souboru packed_matrix.cpp ***/
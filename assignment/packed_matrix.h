@@ -0,0 +1,284 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Packed triangular, symmetric and banded matrices
+//
+// $NoKeywords: $ivs_project_1 $packed_matrix.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file packed_matrix.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace matic s kompaktnim ulozenim: trojuhelnikove a symetricke
+ *        (n * (n + 1) / 2 prvku) a pasove (n * (kl + ku + 1) prvku).
+ *
+ * Vsechny typy nabizi nasobeni vektorem, reseni soustavy a prevod z/do
+ * BasicMatrix. Reseni soustav se pocita v MatrixTraits<T>::WorkType stejne
+ * jako v BasicMatrix.
+ */
+
+#pragma once
+
+#ifndef PACKED_MATRIX_H_
+#define PACKED_MATRIX_H_
+
+#include <vector>
+
+#include "white_box_code.h"
+
+/**
+ * @brief The TriangularMatrix class
+ * Ctvercova trojuhelnikova matice, ulozeny trojuhelnik po radcich.
+ *
+ * @tparam T typ prvku
+ */
+template <typename T>
+class TriangularMatrix
+{
+public:
+    /**
+     * @brief The Triangle_t enum
+     * Ulozeny trojuhelnik (vcetne diagonaly).
+     */
+    enum Triangle_t {
+        UPPER,
+        LOWER
+    };
+
+    /**
+     * @brief TriangularMatrix
+     * Konstruktor vytvori nulovou matici radu n.
+     * @param n        rad matice
+     * @param triangle ulozeny trojuhelnik
+     */
+    TriangularMatrix(size_t n, Triangle_t triangle);
+
+    /**
+     * @brief fromMatrix
+     * @return Vraci trojuhelnikovou matici se stejnymi prvky.
+     * @throws std::runtime_error pro obdelnikovou matici nebo nenulovy prvek
+     *         mimo trojuhelnik
+     */
+    static TriangularMatrix fromMatrix(const BasicMatrix<T> &m, Triangle_t triangle);
+
+    /**
+     * @brief toMatrix
+     * @return Vraci plnou matici se stejnymi prvky.
+     */
+    BasicMatrix<T> toMatrix() const;
+
+    /**
+     * @brief get
+     * @return Vraci prvek na pozici row, col (mimo trojuhelnik 0).
+     * @throws std::runtime_error pro index mimo matici
+     */
+    T get(size_t row, size_t col) const;
+
+    /**
+     * @brief set
+     * Nastavi prvek na pozici row, col.
+     * @throws std::runtime_error pro index mimo ulozeny trojuhelnik
+     */
+    void set(size_t row, size_t col, T value);
+
+    /**
+     * @brief multiply
+     * @return Vraci soucin matice a vektoru x, O(n^2 / 2).
+     */
+    std::vector<T> multiply(const std::vector<T> &x) const;
+
+    /**
+     * @brief solve
+     * Vyresi soustavu dosazovanim, O(n^2 / 2).
+     * @return Vraci reseni x soustavy A * x = b.
+     * @throws std::runtime_error pro nulovy prvek na diagonale
+     */
+    std::vector<T> solve(const std::vector<T> &b) const;
+
+    size_t size() const { return m_n; }
+
+    Triangle_t triangle() const { return m_triangle; }
+
+protected:
+    /**
+     * @brief index
+     * @return Vraci index prvku (row, col) uvnitr trojuhelniku v m_values.
+     */
+    size_t index(size_t row, size_t col) const;
+
+    /**
+     * @brief contains
+     * @return Vraci true, pokud pozice lezi v ulozenem trojuhelniku.
+     */
+    bool contains(size_t row, size_t col) const;
+
+    std::vector<T> m_values;        ///< Prvky trojuhelniku po radcich.
+    size_t m_n;                     ///< Rad matice.
+    Triangle_t m_triangle;          ///< Ulozeny trojuhelnik.
+};
+
+/**
+ * @brief The SymmetricMatrix class
+ * Ctvercova symetricka matice, ulozen dolni trojuhelnik po radcich.
+ *
+ * @tparam T typ prvku
+ */
+template <typename T>
+class SymmetricMatrix
+{
+public:
+    /**
+     * @brief SymmetricMatrix
+     * Konstruktor vytvori nulovou matici radu n.
+     */
+    explicit SymmetricMatrix(size_t n);
+
+    /**
+     * @brief fromMatrix
+     * @return Vraci symetrickou matici se stejnymi prvky.
+     * @throws std::runtime_error pro nesymetrickou matici
+     */
+    static SymmetricMatrix fromMatrix(const BasicMatrix<T> &m);
+
+    /**
+     * @brief toMatrix
+     * @return Vraci plnou matici se stejnymi prvky.
+     */
+    BasicMatrix<T> toMatrix() const;
+
+    /**
+     * @brief get
+     * @return Vraci prvek na pozici row, col.
+     */
+    T get(size_t row, size_t col) const;
+
+    /**
+     * @brief set
+     * Nastavi prvky na pozicich (row, col) a (col, row).
+     */
+    void set(size_t row, size_t col, T value);
+
+    /**
+     * @brief multiply
+     * @return Vraci soucin matice a vektoru x, kazdy ulozeny prvek se cte jednou.
+     */
+    std::vector<T> multiply(const std::vector<T> &x) const;
+
+    /**
+     * @brief solve
+     * Vyresi soustavu pomoci rozkladu P * A * P^T = L * D * L^T se symetrickou
+     * pivotaci (Bunch-Kaufman, D ma bloky 1x1 a 2x2), O(n^3 / 3). Funguje i pro
+     * indefinitni matice.
+     * @return Vraci reseni x soustavy A * x = b.
+     * @throws std::runtime_error pro singularni matici
+     */
+    std::vector<T> solve(const std::vector<T> &b) const;
+
+    size_t size() const { return m_n; }
+
+protected:
+    /**
+     * @brief index
+     * @return Vraci index prvku (row, col), row >= col, v m_values.
+     */
+    static size_t index(size_t row, size_t col)
+    {
+        return row * (row + 1) / 2 + col;
+    }
+
+    std::vector<T> m_values;        ///< Dolni trojuhelnik po radcich.
+    size_t m_n;                     ///< Rad matice.
+};
+
+/**
+ * @brief The BandedMatrix class
+ * Ctvercova pasova matice s kl poddiagonalami a ku naddiagonalami. Radek i
+ * uklada sloupce i - kl .. i + ku (kl + ku + 1 prvku).
+ *
+ * @tparam T typ prvku
+ */
+template <typename T>
+class BandedMatrix
+{
+public:
+    /**
+     * @brief BandedMatrix
+     * Konstruktor vytvori nulovou pasovou matici.
+     * @param n  rad matice
+     * @param kl pocet poddiagonal
+     * @param ku pocet naddiagonal
+     */
+    BandedMatrix(size_t n, size_t kl, size_t ku);
+
+    /**
+     * @brief fromMatrix
+     * @return Vraci pasovou matici se sirkou pasu podle nenulovych prvku.
+     */
+    static BandedMatrix fromMatrix(const BasicMatrix<T> &m);
+
+    /**
+     * @brief fromMatrix
+     * @return Vraci pasovou matici se zadanou sirkou pasu.
+     * @throws std::runtime_error pro obdelnikovou matici nebo nenulovy prvek
+     *         mimo pas
+     */
+    static BandedMatrix fromMatrix(const BasicMatrix<T> &m, size_t kl, size_t ku);
+
+    /**
+     * @brief toMatrix
+     * @return Vraci plnou matici se stejnymi prvky.
+     */
+    BasicMatrix<T> toMatrix() const;
+
+    /**
+     * @brief get
+     * @return Vraci prvek na pozici row, col (mimo pas 0).
+     */
+    T get(size_t row, size_t col) const;
+
+    /**
+     * @brief set
+     * Nastavi prvek na pozici row, col.
+     * @throws std::runtime_error pro index mimo pas
+     */
+    void set(size_t row, size_t col, T value);
+
+    /**
+     * @brief multiply
+     * @return Vraci soucin matice a vektoru x, O(n * (kl + ku + 1)).
+     */
+    std::vector<T> multiply(const std::vector<T> &x) const;
+
+    /**
+     * @brief solve
+     * Vyresi soustavu Gaussovou eliminaci s castecnou pivotaci uvnitr pasu,
+     * O(n * kl * (kl + ku)), pamet O(n * (2 * kl + ku + 1)).
+     * @return Vraci reseni x soustavy A * x = b.
+     * @throws std::runtime_error pro singularni matici
+     */
+    std::vector<T> solve(const std::vector<T> &b) const;
+
+    size_t size() const { return m_n; }
+
+    size_t lowerBandwidth() const { return m_kl; }
+
+    size_t upperBandwidth() const { return m_ku; }
+
+protected:
+    /**
+     * @brief contains
+     * @return Vraci true, pokud pozice lezi v pasu.
+     */
+    bool contains(size_t row, size_t col) const
+    {
+        return col + m_kl >= row && col <= row + m_ku;
+    }
+
+    std::vector<T> m_values;        ///< Pas po radcich (n x (kl + ku + 1)).
+    size_t m_n;                     ///< Rad matice.
+    size_t m_kl;                    ///< Pocet poddiagonal.
+    size_t m_ku;                    ///< Pocet naddiagonal.
+};
+
+#endif // PACKED_MATRIX_H_
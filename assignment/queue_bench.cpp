@@ -0,0 +1,151 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Test Driven Development - priority queue benchmarks
+//
+// $NoKeywords: $ivs_project_1 $queue_bench.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file queue_bench.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Porovnani implementaci prioritni fronty (Google Benchmark): spojovy
+ *        seznam, binarni halda s handly a d-arni haldy.
+ *
+ * Kazde mereni hlasi pocet operaci fronty za sekundu (items_per_second) a
+ * pocet alokaci na iteraci (allocs).
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "tdd_code.h"
+#include "heap_priority_queue.h"
+#include "dary_heap.h"
+#include "alloc_tracker.h"
+
+//============================================================================//
+// Pomocne funkce
+//============================================================================//
+
+/**
+ * Pseudonahodne hodnoty pro plneni front
+ * @param count pocet hodnot
+ * @return hodnoty 0 .. 2^20 - 1
+ */
+static std::vector<int> randomValues(size_t count)
+{
+    std::vector<int> values(count);
+    uint32_t seed = 12345;
+
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        values[i] = int(seed >> 12);
+    }
+
+    return values;
+}
+
+/**
+ * Zapise citace mereni
+ * @param state stav mereni
+ * @param operations pocet operaci fronty jedne iterace
+ * @param allocs alokace behem mereni
+ */
+static void report(benchmark::State &state, double operations, const AllocTracker &allocs)
+{
+    state.counters["allocs"] = benchmark::Counter(double(allocs.allocations()),
+                                                  benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(int64_t(operations * double(state.iterations())));
+}
+
+//============================================================================//
+// Mereni
+//============================================================================//
+
+/**
+ * Vlozi n hodnot a vsechny odebere
+ */
+template <typename Queue>
+static void BM_FillDrain(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    std::vector<int> values = randomValues(n);
+    AllocTracker allocs;
+
+    for (auto _ : state) {
+        Queue queue;
+        int value;
+
+        for (size_t i = 0; i < n; i++) {
+            queue.Insert(values[i]);
+        }
+
+        while (queue.PopTop(&value)) {
+            benchmark::DoNotOptimize(value);
+        }
+    }
+
+    report(state, 2.0 * n, allocs);
+}
+
+/**
+ * Nejmensi klic hold modelu, pod nim se klic vrati o HOLD_WRAP nahoru
+ */
+static const int HOLD_FLOOR = -(1 << 30);
+static const int HOLD_WRAP = 1 << 30;
+
+/**
+ * Hold model: fronta s n prvky, kazda operace odebere vrchol a vlozi mensi
+ * hodnotu (casovace, Dijkstra). Klice se drzi v rozsahu
+ * [HOLD_FLOOR, 2^20), int tedy nikdy nepretece.
+ */
+template <typename Queue>
+static void BM_Hold(benchmark::State &state)
+{
+    size_t n = state.range(0);
+    std::vector<int> values = randomValues(n);
+    std::vector<int> steps = randomValues(1024);
+    Queue queue;
+
+    for (size_t i = 0; i < n; i++) {
+        queue.Insert(values[i]);
+    }
+
+    AllocTracker allocs;
+    size_t i = 0;
+    int value;
+
+    for (auto _ : state) {
+        queue.PopTop(&value);
+
+        int next = value - (steps[i++ & 1023] & 0xffff);
+        if (next < HOLD_FLOOR) {
+            next += HOLD_WRAP;
+        }
+
+        queue.Insert(next);
+    }
+
+    report(state, 2.0, allocs);
+}
+
+//linked list has O(n) insert, keep it to small sizes
+BENCHMARK_TEMPLATE(BM_FillDrain, PriorityQueue)->RangeMultiplier(8)->Range(64, 4096);
+BENCHMARK_TEMPLATE(BM_FillDrain, HeapPriorityQueue)->RangeMultiplier(8)->Range(64, 1 << 21);
+BENCHMARK_TEMPLATE(BM_FillDrain, DaryHeap<2>)->RangeMultiplier(8)->Range(64, 1 << 21);
+BENCHMARK_TEMPLATE(BM_FillDrain, DaryHeap<4>)->RangeMultiplier(8)->Range(64, 1 << 21);
+BENCHMARK_TEMPLATE(BM_FillDrain, DaryHeap<8>)->RangeMultiplier(8)->Range(64, 1 << 21);
+
+BENCHMARK_TEMPLATE(BM_Hold, PriorityQueue)->RangeMultiplier(8)->Range(64, 4096);
+BENCHMARK_TEMPLATE(BM_Hold, HeapPriorityQueue)->RangeMultiplier(8)->Range(64, 1 << 21);
+BENCHMARK_TEMPLATE(BM_Hold, DaryHeap<2>)->RangeMultiplier(8)->Range(64, 1 << 21);
+BENCHMARK_TEMPLATE(BM_Hold, DaryHeap<4>)->RangeMultiplier(8)->Range(64, 1 << 21);
+BENCHMARK_TEMPLATE(BM_Hold, DaryHeap<8>)->RangeMultiplier(8)->Range(64, 1 << 21);
+
+BENCHMARK_MAIN();
+
+/*** Konec souboru queue_bench.cpp ***/
@@ -0,0 +1,348 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Work-stealing task scheduler with dependency tracking
+//
+// $NoKeywords: $ivs_project_1 $task_scheduler.cpp
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file task_scheduler.cpp
+ * @author Lukáš Plevač
+ *
+ * @brief Implementace planovace uloh s grafem zavislosti.
+ */
+
+#include <algorithm>
+
+#include "task_scheduler.h"
+#include "numa_topology.h"
+
+/**
+ * Planovac, jehoz pracovnim vlaknem je aktualni vlakno (NULL pro cizi vlakna)
+ */
+static thread_local const TaskScheduler *t_pScheduler = NULL;
+
+/**
+ * Index fronty aktualniho pracovniho vlakna
+ */
+static thread_local size_t t_queueIndex = 0;
+
+/**
+ * @brief The RunState_t struct
+ * Stav jednoho behu grafu uloh.
+ */
+struct TaskScheduler::RunState_t {
+    TaskGraph *pGraph;                                  ///< Provadeny graf.
+    std::unique_ptr<std::atomic<size_t>[]> pending;     ///< Nedokoncene predchudce uloh.
+    std::atomic<size_t> remaining;                      ///< Pocet nedokoncenych uloh.
+    std::atomic<bool> failed;                           ///< Nektera uloha vyhodila vyjimku.
+    std::mutex errorLock;
+    std::exception_ptr error;                           ///< Prvni vyhozena vyjimka.
+    std::unique_ptr<TaskGraph> ownedGraph;              ///< Graf samostatne ulohy (spawn), jinak NULL.
+};
+
+const size_t TaskGraph::ANY_WORKER;
+
+size_t TaskGraph::addTask(std::function<void()> fn, size_t worker)
+{
+    Node_t node;
+    node.fn = fn;
+    node.predecessors = 0;
+    node.worker = worker;
+
+    m_nodes.push_back(node);
+
+    return m_nodes.size() - 1;
+}
+
+void TaskGraph::addDependency(size_t before, size_t after)
+{
+    m_nodes[before].successors.push_back(after);
+    m_nodes[after].predecessors++;
+}
+
+size_t TaskGraph::size() const
+{
+    return m_nodes.size();
+}
+
+TaskScheduler::TaskScheduler(unsigned threads)
+    : m_queued(0), m_stop(false)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    //last queue is shared by all threads that are not workers
+    m_queueCount = threads;
+    m_queues.reset(new Queue_t[m_queueCount]);
+
+    for (size_t i = 0; i + 1 < threads; i++) {
+        m_workers.push_back(std::thread(&TaskScheduler::workerLoop, this, i));
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeLock);
+        m_stop = true;
+    }
+
+    m_wake.notify_all();
+
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        m_workers[i].join();
+    }
+}
+
+TaskScheduler &TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+
+    return scheduler;
+}
+
+unsigned TaskScheduler::threads() const
+{
+    return m_queueCount;
+}
+
+void TaskScheduler::run(TaskGraph &graph)
+{
+    size_t count = graph.m_nodes.size();
+
+    if (count == 0) {
+        return;
+    }
+
+    RunState_t state;
+    state.pGraph = &graph;
+    state.pending.reset(new std::atomic<size_t>[count]);
+    state.remaining = count;
+    state.failed = false;
+
+    for (size_t i = 0; i < count; i++) {
+        state.pending[i] = graph.m_nodes[i].predecessors;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (graph.m_nodes[i].predecessors == 0) {
+            Item_t item = { &state, i };
+            push(item);
+        }
+    }
+
+    //calling thread helps until whole graph is done
+    while (state.remaining.load() > 0) {
+        if (!tryRunOne()) {
+            std::unique_lock<std::mutex> lock(m_wakeLock);
+            m_wake.wait(lock, [&] {
+                return m_queued.load() > 0 || state.remaining.load() == 0;
+            });
+        }
+    }
+
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+void TaskScheduler::spawn(std::function<void()> fn)
+{
+    if (m_workers.empty()) {
+        try {
+            fn();
+        } catch (...) {
+        }
+
+        return;
+    }
+
+    //nobody waits for the run, the last task deletes it
+    RunState_t *state = new RunState_t;
+    state->ownedGraph.reset(new TaskGraph);
+    state->ownedGraph->addTask(fn);
+    state->pGraph = state->ownedGraph.get();
+    state->pending.reset(new std::atomic<size_t>[1]);
+    state->pending[0] = 0;
+    state->remaining = 1;
+    state->failed = false;
+
+    Item_t item = { state, 0 };
+    push(item);
+}
+
+void TaskScheduler::parallelFor(size_t count, const std::function<void(size_t, size_t)> &fn)
+{
+    size_t parts = std::min<size_t>(m_queueCount, count);
+
+    if (parts <= 1) {
+        if (count > 0) {
+            fn(0, count);
+        }
+
+        return;
+    }
+
+    TaskGraph graph;
+
+    for (size_t p = 0; p < parts; p++) {
+        size_t first = count * p / parts;
+        size_t last = count * (p + 1) / parts;
+
+        graph.addTask([&fn, first, last] { fn(first, last); }, p);
+    }
+
+    run(graph);
+}
+
+size_t TaskScheduler::queueIndex() const
+{
+    if (t_pScheduler == this) {
+        return t_queueIndex;
+    }
+
+    return m_queueCount - 1;
+}
+
+void TaskScheduler::push(const Item_t &item)
+{
+    size_t worker = item.pRun->pGraph->m_nodes[item.task].worker;
+    Queue_t &queue = m_queues[worker == TaskGraph::ANY_WORKER ? queueIndex() : worker % m_queueCount];
+
+    {
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.items.push_back(item);
+    }
+
+    m_queued++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeLock);
+    }
+
+    //task for a given worker must wake that worker, not just any idle one
+    if (worker == TaskGraph::ANY_WORKER) {
+        m_wake.notify_one();
+    } else {
+        m_wake.notify_all();
+    }
+}
+
+bool TaskScheduler::tryRunOne()
+{
+    size_t self = queueIndex();
+    Item_t item;
+    bool found = false;
+
+    //own queue from back (most recently released task, hot in cache)
+    {
+        Queue_t &queue = m_queues[self];
+        std::lock_guard<std::mutex> lock(queue.lock);
+
+        if (!queue.items.empty()) {
+            item = queue.items.back();
+            queue.items.pop_back();
+            found = true;
+        }
+    }
+
+    //steal oldest task from other queues
+    for (size_t k = 1; !found && k < m_queueCount; k++) {
+        Queue_t &queue = m_queues[(self + k) % m_queueCount];
+        std::lock_guard<std::mutex> lock(queue.lock);
+
+        if (!queue.items.empty()) {
+            item = queue.items.front();
+            queue.items.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    m_queued--;
+    execute(item);
+
+    return true;
+}
+
+void TaskScheduler::execute(const Item_t &item)
+{
+    RunState_t *run = item.pRun;
+    TaskGraph::Node_t &node = run->pGraph->m_nodes[item.task];
+
+    if (!run->failed.load()) {
+        try {
+            node.fn();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(run->errorLock);
+
+            if (!run->error) {
+                run->error = std::current_exception();
+            }
+
+            run->failed = true;
+        }
+    }
+
+    for (size_t i = 0; i < node.successors.size(); i++) {
+        size_t succ = node.successors[i];
+
+        if (run->pending[succ].fetch_sub(1) == 1) {
+            Item_t next = { run, succ };
+            push(next);
+        }
+    }
+
+    //owner of a waited run may destroy it as soon as remaining drops to 0
+    bool detached = run->ownedGraph != NULL;
+
+    if (run->remaining.fetch_sub(1) == 1) {
+        if (detached) {
+            delete run;
+            return;
+        }
+
+        //run state may be destroyed right after the owner wakes up
+        std::lock_guard<std::mutex> lock(m_wakeLock);
+        m_wake.notify_all();
+    }
+}
+
+void TaskScheduler::workerLoop(size_t index)
+{
+    t_pScheduler = this;
+    t_queueIndex = index;
+
+    const NumaTopology &topology = NumaTopology::instance();
+
+    if (topology.nodes() > 1) {
+        NumaTopology::pinCurrentThread(topology.cpus(topology.nodeOf(index, m_queueCount)));
+    }
+
+    while (true) {
+        if (tryRunOne()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeLock);
+        m_wake.wait(lock, [&] {
+            return m_stop || m_queued.load() > 0;
+        });
+
+        if (m_stop && m_queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+/*** Konec souboru task_scheduler.cpp ***/
@@ -0,0 +1,215 @@
+//======== Copyright (c) 2021, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     Work-stealing task scheduler with dependency tracking
+//
+// $NoKeywords: $ivs_project_1 $task_scheduler.h
+// $Author:     Lukáš Plevač <xpleva07@stud.fit.vutbr.cz>
+// $Date:       $2021-03-10
+//============================================================================//
+/**
+ * @file task_scheduler.h
+ * @author Lukáš Plevač
+ *
+ * @brief Deklarace planovace uloh s grafem zavislosti (task DAG).
+ */
+
+#pragma once
+
+#ifndef TASK_SCHEDULER_H_
+#define TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The TaskGraph class
+ * Orientovany acyklicky graf uloh. Uloha se spusti az ve chvili, kdy jsou
+ * dokonceny vsechny ulohy, na kterych zavisi.
+ */
+class TaskGraph
+{
+public:
+    /**
+     * Uloha bez preferovaneho vlakna
+     */
+    static const size_t ANY_WORKER = static_cast<size_t>(-1);
+
+    /**
+     * @brief addTask
+     * Prida do grafu novou ulohu.
+     * @param fn     Funkce provadena ulohou.
+     * @param worker Index vlakna (fronty), do jehoz fronty se uloha zaradi,
+     *               ANY_WORKER pro frontu vlakna, ktere ulohu uvolnilo.
+     *               Necinna vlakna ji presto mohou ukrast.
+     * @return Vraci identifikator ulohy pro addDependency().
+     */
+    size_t addTask(std::function<void()> fn, size_t worker = ANY_WORKER);
+
+    /**
+     * @brief addDependency
+     * Uloha "after" se spusti az po dokonceni ulohy "before".
+     * @param before Identifikator predchazejici ulohy.
+     * @param after  Identifikator zavisle ulohy.
+     */
+    void addDependency(size_t before, size_t after);
+
+    /**
+     * @brief size
+     * @return Vraci pocet uloh v grafu.
+     */
+    size_t size() const;
+
+protected:
+    friend class TaskScheduler;
+
+    /**
+     * @brief The Node_t struct
+     * Uzel grafu uloh.
+     */
+    struct Node_t {
+        std::function<void()> fn;           ///< Funkce ulohy.
+        std::vector<size_t> successors;     ///< Ulohy zavisle na teto uloze.
+        size_t predecessors;                ///< Pocet uloh, na kterych uloha zavisi.
+        size_t worker;                      ///< Preferovane vlakno (ANY_WORKER).
+    };
+
+    std::vector<Node_t> m_nodes;            ///< Ulohy grafu.
+};
+
+/**
+ * @brief The TaskScheduler class
+ * Planovac uloh nad pevnou sadou pracovnich vlaken. Kazde vlakno ma vlastni
+ * frontu pripravenych uloh (bere z konce), necinna vlakna kradou ulohy
+ * ze zacatku front ostatnich vlaken. Vlakno volajici run() se na vypoctu
+ * podili take.
+ *
+ * Na systemech s vice NUMA uzly jsou pracovni vlakna pripnuta k uzlum,
+ * vlakno (fronta) i patri uzlu NumaTopology::nodeOf(i, threads()).
+ */
+class TaskScheduler
+{
+public:
+    /**
+     * @brief TaskScheduler
+     * Konstruktor, spusti pracovni vlakna.
+     * @param threads Celkovy pocet vlaken vcetne volajiciho, 0 znamena pocet
+     *                hardwarovych vlaken.
+     */
+    explicit TaskScheduler(unsigned threads = 0);
+
+    /**
+     * @brief ~TaskScheduler
+     * Destruktor, ukonci pracovni vlakna.
+     */
+    ~TaskScheduler();
+
+    /**
+     * @brief instance
+     * @return Vraci sdileny planovac s poctem vlaken podle hardwaru.
+     */
+    static TaskScheduler &instance();
+
+    /**
+     * @brief run
+     * Provede vsechny ulohy grafu s ohledem na jejich zavislosti a vrati se
+     * az po dokonceni vsech uloh. Pokud nektera uloha vyhodi vyjimku, zbyvajici
+     * ulohy se jiz neprovadi a prvni vyjimka je vyhozena z run().
+     * @param graph Graf uloh.
+     */
+    void run(TaskGraph &graph);
+
+    /**
+     * @brief spawn
+     * Zaradi samostatnou ulohu a hned se vrati, ulohu provede nektere
+     * pracovni vlakno. Planovac bez pracovnich vlaken (threads() == 1) ji
+     * provede hned ve volajicim vlakne. Vyjimka ulohy se zahodi.
+     * @param fn Funkce provadena ulohou.
+     */
+    void spawn(std::function<void()> fn);
+
+    /**
+     * @brief parallelFor
+     * Staticky rozdeli interval [0, count) na nejvyse threads() souvislych
+     * casti, cast p se zaradi do fronty vlakna p. Stejne rozdeleni stejne
+     * velikosti tak pripadne stejnym vlaknum (a NUMA uzlum), napr. bloky radku
+     * matice zpracovava uzel, na kterem byla jejich pamet poprve zapsana.
+     * @param count Velikost intervalu.
+     * @param fn    Funkce volana pro kazdou cast jako fn(first, last).
+     */
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)> &fn);
+
+    /**
+     * @brief threads
+     * @return Vraci celkovy pocet vlaken, ktera se podili na vypoctu.
+     */
+    unsigned threads() const;
+
+protected:
+    struct RunState_t;
+
+    /**
+     * @brief The Item_t struct
+     * Pripravena uloha ve fronte vlakna.
+     */
+    struct Item_t {
+        RunState_t *pRun;       ///< Beh grafu, do ktereho uloha patri.
+        size_t task;            ///< Index ulohy v grafu.
+    };
+
+    /**
+     * @brief The Queue_t struct
+     * Fronta pripravenych uloh jednoho vlakna.
+     */
+    struct Queue_t {
+        std::mutex lock;
+        std::deque<Item_t> items;
+    };
+
+    /**
+     * @brief push
+     * Zaradi pripravenou ulohu do fronty aktualniho vlakna.
+     */
+    void push(const Item_t &item);
+
+    /**
+     * @brief tryRunOne
+     * Vezme ulohu z vlastni fronty, pripadne ji ukradne jinemu vlaknu, a provede ji.
+     * @return Vraci true, pokud byla nejaka uloha provedena.
+     */
+    bool tryRunOne();
+
+    /**
+     * @brief execute
+     * Provede ulohu a uvolni ulohy, ktere na ni zavisi.
+     */
+    void execute(const Item_t &item);
+
+    /**
+     * @brief workerLoop
+     * Hlavni smycka pracovniho vlakna.
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * @brief queueIndex
+     * @return Vraci index fronty aktualniho vlakna (cizi vlakna sdili posledni frontu).
+     */
+    size_t queueIndex() const;
+
+    std::vector<std::thread> m_workers;             ///< Pracovni vlakna.
+    std::unique_ptr<Queue_t[]> m_queues;            ///< Fronty vlaken + sdilena fronta.
+    size_t m_queueCount;                            ///< Pocet front.
+    std::atomic<size_t> m_queued;                   ///< Pocet uloh ve vsech frontach.
+    std::mutex m_wakeLock;
+    std::condition_variable m_wake;                 ///< Probouzeni necinnych vlaken.
+    bool m_stop;                                    ///< Pozadavek na ukonceni vlaken.
+};
+
+#endif // TASK_SCHEDULER_H_
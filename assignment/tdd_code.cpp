@@ -16,7 +16,12 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 #include "tdd_code.h"
+#include "instrumentation.h"
 
 //============================================================================//
 // ** ZDE DOPLNTE IMPLEMENTACI **
@@ -32,91 +37,385 @@
 // (tdd_tests.cpp).
 //============================================================================//
 
+/**
+ * Pocet polozek prvniho a nejvetsiho alokovaneho bloku
+ */
+static const size_t SLAB_MIN = 32;
+static const size_t SLAB_MAX = 4096;
+
 PriorityQueue::PriorityQueue()
 {
-    this->m_pHead = NULL;
+    this->m_pHead    = NULL;
+    this->m_pFree    = NULL;
+    this->m_pSlabs   = NULL;
+    this->m_slabSize = SLAB_MIN;
+    this->m_indexed  = false;
+    this->m_indexCount = 0;
+}
+
+PriorityQueue::PriorityQueue(Element_t *pBuffer, size_t count)
+    : PriorityQueue()
+{
+    //caller memory goes to free list, it is never released by the queue
+    for (size_t i = count; i > 0; i--) {
+        this->freeElement(&pBuffer[i - 1]);
+    }
+}
+
+PriorityQueue::PriorityQueue(const int *pValues, size_t count)
+    : PriorityQueue()
+{
+    this->InsertMany(pValues, count);
 }
 
 PriorityQueue::~PriorityQueue()
 {
-    //todo remove all elements
-    auto el = this->GetHead();
+    //elements are not released one by one, only whole slabs
+    auto slab = this->m_pSlabs;
 
-    while (el != NULL) {
-        auto tmp_next = el->pNext;
-        delete el;
-        el = tmp_next;
+    while (slab != NULL) {
+        auto tmp_next = slab->pNext;
+        delete[] slab;
+        slab = tmp_next;
+    }
+}
+
+PriorityQueue::Element_t *PriorityQueue::allocElement()
+{
+    if (this->m_pFree == NULL) {
+        //scope only around the slab allocation, the free list path stays untimed
+        IVS_TRACE_SCOPE("PriorityQueue::allocSlab");
+        IVS_TRACE_ALLOCS(1);
+
+        //first element of slab links slabs together
+        auto slab = new PriorityQueue::Element_t[this->m_slabSize + 1];
+        slab[0].pNext  = this->m_pSlabs;
+        this->m_pSlabs = slab;
+
+        for (size_t i = 1; i < this->m_slabSize; i++) {
+            slab[i].pNext = &slab[i + 1];
+        }
+
+        slab[this->m_slabSize].pNext = NULL;
+        this->m_pFree = &slab[1];
+
+        if (this->m_slabSize < SLAB_MAX) {
+            this->m_slabSize *= 2;
+        }
+    }
+
+    auto el = this->m_pFree;
+    this->m_pFree = el->pNext;
+
+    return el;
+}
+
+void PriorityQueue::freeElement(Element_t *el)
+{
+    //last freed element is reused first, it is still in cache
+    el->pNext = this->m_pFree;
+    this->m_pFree = el;
+}
+
+void PriorityQueue::linkAt(Element_t **link, Element_t *el)
+{
+    el->pNext = *link;
+    *link = el;
+
+    if (!this->m_indexed) {
+        return;
+    }
+
+    //el is last of its run now, following run starts behind it
+    auto next = el->pNext;
+    if (next != NULL && next->value != el->value) {
+        this->indexFind(next->value)->link = &el->pNext;
+    }
+
+    //link of existing run stays, el is either its new first element or inside it
+    auto slot = this->indexFind(el->value);
+    if (slot != NULL) {
+        slot->count++;
+    } else {
+        this->indexAdd(el->value, link);
+    }
+}
+
+PriorityQueue::Element_t *PriorityQueue::unlinkAt(Element_t **link)
+{
+    auto el = *link;
+    *link = el->pNext;
+
+    if (!this->m_indexed) {
+        return el;
+    }
+
+    //el was last of its run, following run starts at its link now
+    auto next = el->pNext;
+    if (next != NULL && next->value != el->value) {
+        this->indexFind(next->value)->link = link;
+    }
+
+    auto slot = this->indexFind(el->value);
+    if (--slot->count == 0) {
+        this->indexErase(slot);
+    }
+
+    return el;
+}
+
+size_t PriorityQueue::indexHome(int value) const
+{
+    //fibonacci hashing, high bits are the best mixed
+    uint32_t hash = uint32_t(value) * 2654435769u;
+
+    return size_t((uint64_t(hash) * this->m_index.size()) >> 32);
+}
+
+PriorityQueue::IndexSlot_t *PriorityQueue::indexFind(int value)
+{
+    if (this->m_indexCount == 0) {
+        return NULL;
+    }
+
+    IVS_TRACE_SCOPE("PriorityQueue::indexFind");
+
+    size_t mask = this->m_index.size() - 1;
+
+    for (size_t i = this->indexHome(value); this->m_index[i].count != 0; i = (i + 1) & mask) {
+        IVS_TRACE_STEPS(1);
+
+        if (this->m_index[i].value == value) {
+            return &this->m_index[i];
+        }
+    }
+
+    return NULL;
+}
+
+void PriorityQueue::indexAdd(int value, Element_t **link)
+{
+    //keep load factor at most 1/2, probe sequences stay short
+    if (2 * (this->m_indexCount + 1) > this->m_index.size()) {
+        IVS_TRACE_SCOPE("PriorityQueue::indexGrow");
+        IVS_TRACE_ALLOCS(1);
+
+        std::vector<IndexSlot_t> old;
+        old.swap(this->m_index);
+        this->m_index.assign(old.empty() ? 16 : 2 * old.size(), IndexSlot_t{NULL, 0, 0});
+        this->m_indexCount = 0;
+
+        for (auto &slot : old) {
+            if (slot.count != 0) {
+                this->indexAdd(slot.value, slot.link);
+                this->indexFind(slot.value)->count = slot.count;
+            }
+        }
+    }
+
+    size_t mask = this->m_index.size() - 1;
+    size_t i = this->indexHome(value);
+
+    while (this->m_index[i].count != 0) {
+        i = (i + 1) & mask;
+    }
+
+    this->m_index[i] = IndexSlot_t{link, 1, value};
+    this->m_indexCount++;
+}
+
+void PriorityQueue::indexErase(IndexSlot_t *slot)
+{
+    size_t mask = this->m_index.size() - 1;
+    size_t hole = slot - this->m_index.data();
+
+    //backward shift: move up every following slot whose home is not between hole and it
+    for (size_t i = (hole + 1) & mask; this->m_index[i].count != 0; i = (i + 1) & mask) {
+        size_t home = this->indexHome(this->m_index[i].value);
+
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            this->m_index[hole] = this->m_index[i];
+            hole = i;
+        }
+    }
+
+    this->m_index[hole].count = 0;
+    this->m_indexCount--;
+}
+
+void PriorityQueue::SetIndexed(bool indexed)
+{
+    this->m_indexed = false;
+    this->m_index.clear();
+    this->m_indexCount = 0;
+
+    if (!indexed) {
+        return;
+    }
+
+    this->m_indexed = true;
+
+    //register runs of equal values in one pass
+    auto link = &this->m_pHead;
+    while (*link != NULL) {
+        auto slot = this->indexFind((*link)->value);
+
+        if (slot != NULL) {
+            slot->count++;
+        } else {
+            this->indexAdd((*link)->value, link);
+        }
+
+        link = &(*link)->pNext;
     }
 }
 
 void PriorityQueue::Insert(int value)
 {
-    auto next = this->GetHead();
-    auto el    = new PriorityQueue::Element_t;
+    IVS_TRACE_SCOPE("PriorityQueue::Insert");
+
+    auto link = &this->m_pHead;
+    auto slot = this->m_indexed ? this->indexFind(value) : NULL;
 
+    if (slot != NULL) {
+        //value already present, place new element in front of its run
+        link = slot->link;
+    } else {
+        //find correct postion
+        while (*link != NULL && (*link)->value > value) {
+            IVS_TRACE_STEPS(1);
+
+            link = &(*link)->pNext;
+        }
+    }
+
+    auto el = this->allocElement();
     el->value = value;
 
-    //find correct postion
-    PriorityQueue::Element_t *previous = NULL;
-    while (next  != NULL) {
-        if (next->value <= value) {
-            break;
+    this->linkAt(link, el);
+}
+
+void PriorityQueue::InsertMany(const int *pValues, size_t count)
+{
+    IVS_TRACE_SCOPE("PriorityQueue::InsertMany");
+
+    std::vector<int> sorted(pValues, pValues + count);
+    std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+
+    //merge sorted batch into list, link always points past last placed element
+    auto link = &this->m_pHead;
+
+    for (size_t i = 0; i < count; i++) {
+        while (*link != NULL && (*link)->value > sorted[i]) {
+            IVS_TRACE_STEPS(1);
+
+            link = &(*link)->pNext;
         }
 
-        previous = next;
-        next        = next->pNext;
+        auto el = this->allocElement();
+        el->value = sorted[i];
+
+        this->linkAt(link, el);
+        link = &el->pNext;
     }
+}
 
-    //relink
-    if (previous == NULL) {
-        //first element
+bool PriorityQueue::PopTop(int *pValue)
+{
+    return this->PopTop(1, pValue) == 1;
+}
 
-        el->pNext = NULL;
-        if (next != NULL) {
-            //not empty list
-            el->pNext = next;
+size_t PriorityQueue::PopTop(size_t k, int *pOut)
+{
+    IVS_TRACE_SCOPE("PriorityQueue::PopTop");
+
+    size_t count = 0;
+
+    //top elements are a prefix of the list
+    while (this->m_pHead != NULL && count < k) {
+        auto el = this->unlinkAt(&this->m_pHead);
+
+        if (pOut != NULL) {
+            pOut[count] = el->value;
         }
 
-        this->m_pHead = el;
-    } else {
-        el->pNext             = next;
-        previous->pNext = el;
+        this->freeElement(el);
+        count++;
     }
+
+    return count;
 }
 
-bool PriorityQueue::Remove(int value)
+size_t PriorityQueue::DrainWhile(const std::function<bool(int)> &predicate, std::vector<int> &out)
 {
-    auto to_remove = this->Find(value);
+    IVS_TRACE_SCOPE("PriorityQueue::DrainWhile");
+
+    size_t count = 0;
+
+    while (this->m_pHead != NULL && predicate(this->m_pHead->value)) {
+        auto el = this->unlinkAt(&this->m_pHead);
 
-    if (to_remove == NULL) {
-        return false;
+        out.push_back(el->value);
+
+        this->freeElement(el);
+        count++;
     }
 
-    //re-link
-    if (this->GetHead() == to_remove) {
-        //on top
-        this->m_pHead = to_remove->pNext;
+    return count;
+}
+
+bool PriorityQueue::Remove(int value)
+{
+    IVS_TRACE_SCOPE("PriorityQueue::Remove");
+
+    //single pass, keep link pointing to current element
+    auto link = &this->m_pHead;
+
+    if (this->m_indexed) {
+        auto slot = this->indexFind(value);
+
+        if (slot == NULL) {
+            return false;
+        }
+
+        link = slot->link;
     } else {
-        //not on top have previous element
-        auto previous = this->GetHead();
+        while (*link != NULL && (*link)->value != value) {
+            if ((*link)->value < value) {
+                //sorted max->min, value can not follow
+                return false;
+            }
+
+            IVS_TRACE_STEPS(1);
 
-        while (previous->pNext != to_remove) {
-            previous = previous->pNext;
+            link = &(*link)->pNext;
         }
 
-        previous->pNext = to_remove->pNext;
+        if (*link == NULL) {
+            return false;
+        }
     }
 
-    //remove element by pointer
-    delete to_remove;
+    //re-link and return element to free list
+    this->freeElement(this->unlinkAt(link));
 
     return true;
 }
 
 PriorityQueue::Element_t *PriorityQueue::Find(int value)
 {
+    IVS_TRACE_SCOPE("PriorityQueue::Find");
+
+    if (this->m_indexed) {
+        auto slot = this->indexFind(value);
+
+        return slot != NULL ? *slot->link : NULL;
+    }
+
     auto el = this->GetHead();
     while (el != NULL) {
+        IVS_TRACE_STEPS(1);
+
         if (el->value == value) {
             return el;
         }
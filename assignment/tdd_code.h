@@ -18,12 +18,25 @@
 #ifndef TDD_CODE_H_
 #define TDD_CODE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
 /**
  * @brief The PriorityQueue class
  * Prioritni fronta (polozky vzdy serazeny od max po min) implementovana pomoci
  * tzv. linked listu (kazda polozka ma odkaz na  nasledujici polozku).
  * Dale ma kazda polozka hodnotu typu "int", pricemz fronta muze obsahovat vice
  * polozek se stejnou hodnotou.
+ *
+ * Polozky se alokuji po blocich (slab) a uvolnene polozky se vraci do free
+ * listu fronty, Insert tedy alokuje jen pri vycerpani vsech bloku.
+ *
+ * Volitelny index hodnot (SetIndexed) je hashovaci tabulka s otevrenym
+ * adresovanim, ktera pro kazdou hodnotu drzi pocet polozek a odkaz na prvni
+ * z nich. Find, Remove a Insert existujici hodnoty jsou pak prumerne O(1).
  */
 class PriorityQueue
 {
@@ -36,7 +49,8 @@ public:
 
     /**
      * @brief ~PriorityQueue
-     * Destruktor, odstrani vsechny polozky i frontu samotnou.
+     * Destruktor, odstrani vsechny polozky i frontu samotnou. Polozky se
+     * neuvolnuji jednotlive, uvolni se najednou vsechny alokovane bloky.
      */
     ~PriorityQueue();
 
@@ -50,6 +64,24 @@ public:
         int value;          ///< Hodnota teto polozky ve fronte.
     };
 
+    /**
+     * @brief PriorityQueue
+     * Konstruktor, vytvori prazdnou frontu, ktera pro polozky pouzije nejdrive
+     * pamet volajiciho. Teprve po jejim vycerpani alokuje dalsi bloky.
+     * @param pBuffer Pole polozek, musi existovat po celou dobu zivota fronty
+     * (fronta ho neuvolnuje).
+     * @param count Pocet polozek v poli.
+     */
+    PriorityQueue(Element_t *pBuffer, size_t count);
+
+    /**
+     * @brief PriorityQueue
+     * Konstruktor, vytvori frontu s hodnotami "pValues" (viz InsertMany).
+     * @param pValues Pole hodnot novych polozek.
+     * @param count Pocet hodnot.
+     */
+    PriorityQueue(const int *pValues, size_t count);
+
     /**
      * @brief Insert
      * Zaradi novou polozku s hodnotou "value" do fronty na patricne misto (tak
@@ -59,6 +91,41 @@ public:
      */
     void Insert(int value);
 
+    /**
+     * @brief InsertMany
+     * Zaradi najednou "count" polozek s hodnotami "pValues". Hodnoty se
+     * seradi v O(m log m) a slouci s frontou jednim pruchodem v O(n + m),
+     * misto m volani Insert v O(n * m).
+     * @param pValues Pole hodnot novych polozek (v libovolnem poradi).
+     * @param count Pocet hodnot.
+     */
+    void InsertMany(const int *pValues, size_t count);
+
+    /**
+     * @brief PopTop
+     * Odebere polozku s nejvetsi hodnotou.
+     * @param pValue Pokud neni NULL, zapise se sem hodnota odebrane polozky.
+     * @return Vrati false, pokud je fronta prazdna.
+     */
+    bool PopTop(int *pValue = NULL);
+
+    /**
+     * @brief PopTop
+     * Odebere az "k" polozek s nejvetsimi hodnotami jednim pruchodem zacatku seznamu, O(k).
+     * @param k Nejvetsi pocet odebranych polozek.
+     * @param pOut Pole pro alespon "k" hodnot serazenych od max po min, nebo NULL.
+     * @return Vrati pocet odebranych polozek (mene nez k jen pri vyprazdneni fronty).
+     */
+    size_t PopTop(size_t k, int *pOut);
+
+    /**
+     * @brief DrainWhile
+     * Odebira polozky od nejvetsi, dokud pro hodnotu na vrcholu plati
+     * "predicate", a pridava jejich hodnoty na konec "out".
+     * @return Vrati pocet odebranych polozek.
+     */
+    size_t DrainWhile(const std::function<bool(int)> &predicate, std::vector<int> &out);
+
     /**
      * @brief Remove
      * Odstrani polozku s hodnotou "value" z fronty a vrati "true", pokud polozka
@@ -94,8 +161,91 @@ public:
      */
     Element_t *GetHead();
 
+    /**
+     * @brief SetIndexed
+     * Zapne (a sestavi v O(n)) nebo vypne index hodnot. Index stoji pamet
+     * navic a zpomali vkladani novych hodnot, vyplati se pri castem Find/Remove.
+     * @param indexed Zda ma fronta udrzovat index hodnot.
+     */
+    void SetIndexed(bool indexed);
+
+    /**
+     * @brief IsIndexed
+     * @return Vrati true, pokud fronta udrzuje index hodnot.
+     */
+    bool IsIndexed() const { return m_indexed; }
+
 protected:
+    /**
+     * @brief The IndexSlot_t struct
+     * Polozka indexu hodnot, prazdna pri count == 0. Polozky se stejnou hodnotou
+     * tvori v seznamu souvisly usek, "link" je odkaz (m_pHead nebo pNext
+     * predchudce), ktery ukazuje na prvni z nich.
+     */
+    struct IndexSlot_t {
+        Element_t **link;   ///< Odkaz na prvni polozku s hodnotou "value".
+        uint32_t count;     ///< Pocet polozek s hodnotou "value".
+        int value;          ///< Hodnota (klic).
+    };
+
+    /**
+     * @brief linkAt
+     * Vlozi polozku "el" na misto odkazu "link" a aktualizuje index.
+     */
+    void linkAt(Element_t **link, Element_t *el);
+
+    /**
+     * @brief unlinkAt
+     * Vyjme polozku, na kterou ukazuje odkaz "link", a aktualizuje index.
+     * @return Vrati vyjmutou polozku.
+     */
+    Element_t *unlinkAt(Element_t **link);
+
+    /**
+     * @brief indexFind
+     * @return Vrati polozku indexu pro hodnotu "value", nebo NULL.
+     */
+    IndexSlot_t *indexFind(int value);
+
+    /**
+     * @brief indexAdd
+     * Prida do indexu novou hodnotu "value" s jednou polozkou na odkazu "link".
+     */
+    void indexAdd(int value, Element_t **link);
+
+    /**
+     * @brief indexErase
+     * Odstrani polozku indexu (posunem nasledujicich polozek, bez nahrobku).
+     */
+    void indexErase(IndexSlot_t *slot);
+
+    /**
+     * @brief indexHome
+     * @return Vrati vychozi pozici hodnoty "value" v tabulce indexu.
+     */
+    size_t indexHome(int value) const;
+
+    /**
+     * @brief allocElement
+     * Vrati volnou polozku z free listu, pri prazdnem free listu alokuje novy
+     * blok polozek (kazdy dalsi blok je dvakrat vetsi, nejvyse SLAB_MAX).
+     */
+    Element_t *allocElement();
+
+    /**
+     * @brief freeElement
+     * Vrati polozku do free listu, pamet se uvolni az v destruktoru.
+     */
+    void freeElement(Element_t *el);
+
     Element_t *m_pHead;     ///< Ukazatel na zacatek fronty.
+    Element_t *m_pFree;     ///< Volne polozky provazane pres pNext.
+    Element_t *m_pSlabs;    ///< Alokovane bloky, prvni polozka bloku odkazuje na dalsi blok.
+    size_t m_slabSize;      ///< Pocet polozek pristiho bloku.
+
+    bool m_indexed;                     ///< Zda se udrzuje index hodnot.
+    std::vector<IndexSlot_t> m_index;   ///< Tabulka indexu (velikost mocnina 2).
+    size_t m_indexCount;                ///< Pocet obsazenych polozek indexu.
 };
 
 #endif // TDD_CODE_H_
@@ -13,8 +13,22 @@
  * @brief Testy implementace prioritni fronty.
  */
 
+#include <limits.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "tdd_code.h"
+#include "heap_priority_queue.h"
+#include "concurrent_priority_queue.h"
+#include "multi_queue.h"
+#include "integer_queues.h"
+#include "dary_heap.h"
+#include "alloc_tracker.h"
+#include "instrumentation.h"
 
 class NonEmptyQueue : public ::testing::Test
 {
@@ -131,4 +145,894 @@ TEST_F(EmptyQueue, Length)
     EXPECT_EQ(queue.Length(), 0);
 }
 
+TEST_F(NonEmptyQueue, InsertMany)
+{
+    int batch[] = { 100, 0, 55, 90, 55, 42 };
+
+    queue.InsertMany(batch, 6);
+    EXPECT_EQ(queue.Length(), 20);
+    EXPECT_EQ(queue.GetHead()->value, 100);
+
+    size_t count = 0;
+    for(PriorityQueue::Element_t *pElem = queue.GetHead(); pElem != NULL; pElem = pElem->pNext)
+    {
+        EXPECT_TRUE(pElem->pNext == NULL || pElem->pNext->value <= pElem->value);
+        count += pElem->value == 55;
+    }
+
+    EXPECT_EQ(count, 3);
+
+    queue.InsertMany(batch, 0);
+    EXPECT_EQ(queue.Length(), 20);
+}
+
+TEST(RangeQueue, Construct)
+{
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, 5, 55 };
+    PriorityQueue queue(values, 14);
+    HeapPriorityQueue heap(values, 14);
+
+    EXPECT_EQ(queue.Length(), 14);
+    EXPECT_EQ(heap.Length(), 14);
+
+    int sorted[] = { 90, 85, 80, 70, 65, 60, 55, 50, 40, 30, 20, 15, 10, 5 };
+    for(int i = 0; i < 14; ++i)
+    {
+        EXPECT_EQ(queue.GetHead()->value, sorted[i]);
+        EXPECT_EQ(heap.GetHead()->value, sorted[i]);
+        EXPECT_TRUE(queue.Remove(sorted[i]));
+        EXPECT_TRUE(heap.Remove(sorted[i]));
+    }
+}
+
+TEST_F(NonEmptyQueue, PopTop)
+{
+    int value = 0;
+    int out[8];
+
+    EXPECT_TRUE(queue.PopTop(&value));
+    EXPECT_EQ(value, 90);
+    EXPECT_EQ(queue.GetHead()->value, 85);
+
+    EXPECT_EQ(queue.PopTop(4, out), 4);
+    EXPECT_EQ(out[0], 85);
+    EXPECT_EQ(out[3], 65);
+    EXPECT_EQ(queue.Length(), 9);
+
+    std::vector<int> drained;
+    EXPECT_EQ(queue.DrainWhile([](int v) { return v >= 40; }, drained), 4);
+    EXPECT_EQ(drained, std::vector<int>({ 60, 55, 50, 40 }));
+    EXPECT_EQ(queue.GetHead()->value, 30);
+
+    EXPECT_EQ(queue.PopTop(8, out), 5);
+    EXPECT_EQ(out[4], 5);
+    EXPECT_TRUE(queue.GetHead() == NULL);
+    EXPECT_FALSE(queue.PopTop());
+    EXPECT_EQ(queue.DrainWhile([](int) { return true; }, drained), 0);
+}
+
+TEST_F(NonEmptyQueue, Allocations)
+{
+    AllocTracker tracker;
+
+    EXPECT_TRUE(queue.Find(5) != NULL);
+    EXPECT_TRUE(queue.Find(1000) == NULL);
+    EXPECT_TRUE(queue.Remove(5));
+    EXPECT_FALSE(queue.Remove(1000));
+
+    //removed element goes to free list and is reused by next insert
+    EXPECT_EQ(tracker.allocations(), 0);
+    EXPECT_EQ(tracker.deallocations(), 0);
+
+    queue.Insert(42);
+
+    EXPECT_EQ(tracker.allocations(), 0);
+}
+
+TEST_F(NonEmptyQueue, ChurnWithoutAllocations)
+{
+    AllocTracker tracker;
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        int top = queue.GetHead()->value;
+
+        EXPECT_TRUE(queue.Remove(top));
+        queue.Insert((top * 7 + i) % 100);
+    }
+
+    EXPECT_EQ(queue.Length(), 14);
+    EXPECT_EQ(tracker.allocations(), 0);
+    EXPECT_EQ(tracker.deallocations(), 0);
+}
+
+TEST(CallerBufferQueue, NoAllocations)
+{
+    PriorityQueue::Element_t buffer[64];
+    AllocTracker tracker;
+
+    {
+        PriorityQueue queue(buffer, 64);
+
+        for(int i = 0; i < 64; ++i)
+            queue.Insert(i % 10);
+
+        EXPECT_EQ(queue.GetHead()->value, 9);
+        EXPECT_EQ(queue.Length(), 64);
+        EXPECT_EQ(tracker.allocations(), 0);
+
+        //buffer exhausted, queue falls back to its own slab
+        queue.Insert(100);
+        EXPECT_EQ(queue.GetHead()->value, 100);
+        EXPECT_EQ(tracker.allocations(), 1);
+    }
+
+    EXPECT_EQ(tracker.deallocations(), 1);
+}
+
+TEST_F(NonEmptyQueue, IndexedFindRemove)
+{
+    queue.SetIndexed(true);
+    EXPECT_TRUE(queue.IsIndexed());
+
+    queue.Insert(55);
+    queue.Insert(55);
+
+    PriorityQueue::Element_t *el = queue.Find(55);
+    ASSERT_TRUE(el != NULL);
+    EXPECT_EQ(el->value, 55);
+    EXPECT_TRUE(queue.Find(1000) == NULL);
+
+    EXPECT_TRUE(queue.Remove(55));
+    EXPECT_TRUE(queue.Remove(55));
+    EXPECT_TRUE(queue.Remove(55));
+    EXPECT_FALSE(queue.Remove(55));
+    EXPECT_TRUE(queue.Find(55) == NULL);
+
+    EXPECT_TRUE(queue.Remove(90));
+    EXPECT_TRUE(queue.Remove(5));
+    EXPECT_EQ(queue.GetHead()->value, 85);
+    EXPECT_EQ(queue.Length(), 11);
+
+    queue.SetIndexed(false);
+    EXPECT_FALSE(queue.IsIndexed());
+    EXPECT_TRUE(queue.Find(85) != NULL);
+}
+
+TEST(IndexedQueue, MatchesUnindexed)
+{
+    PriorityQueue indexed;
+    PriorityQueue plain;
+
+    indexed.SetIndexed(true);
+
+    unsigned seed = 7;
+    for(int i = 0; i < 5000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int value = int(seed >> 16) % 64;
+
+        switch((seed >> 8) % 5)
+        {
+        case 0:
+        case 1:
+            indexed.Insert(value);
+            plain.Insert(value);
+            break;
+        case 2:
+            ASSERT_EQ(indexed.Remove(value), plain.Remove(value));
+            break;
+        case 3:
+        {
+            int values[] = { value, value, value / 2, value + 3 };
+            indexed.InsertMany(values, 4);
+            plain.InsertMany(values, 4);
+            break;
+        }
+        default:
+            ASSERT_EQ(indexed.PopTop(2, NULL), plain.PopTop(2, NULL));
+            break;
+        }
+
+        ASSERT_EQ(indexed.Find(value) != NULL, plain.Find(value) != NULL);
+    }
+
+    PriorityQueue::Element_t *a = indexed.GetHead();
+    PriorityQueue::Element_t *b = plain.GetHead();
+
+    while(a != NULL && b != NULL)
+    {
+        EXPECT_EQ(a->value, b->value);
+        a = a->pNext;
+        b = b->pNext;
+    }
+
+    EXPECT_TRUE(a == NULL && b == NULL);
+
+    //every value still findable after the churn
+    for(int value = 0; value < 70; ++value)
+    {
+        PriorityQueue::Element_t *el = indexed.Find(value);
+
+        EXPECT_EQ(el != NULL, plain.Find(value) != NULL);
+        if(el != NULL)
+        {
+            EXPECT_EQ(el->value, value);
+        }
+    }
+}
+
+TEST(TracedQueue, SlabAllocations)
+{
+    Instrumentation::reset();
+
+    {
+        PriorityQueue queue;
+
+        //first slab holds 32 elements, 33rd insert allocates second one
+        for(int i = 0; i < 33; ++i)
+            queue.Insert(i);
+    }
+
+    std::string json = Instrumentation::toJson();
+
+    if(Instrumentation::enabled())
+    {
+        EXPECT_NE(json.find("\"PriorityQueue::allocSlab\": {\"calls\": 2,"), std::string::npos);
+        EXPECT_NE(json.find("\"allocs\": 2,"), std::string::npos);
+    }
+    else
+    {
+        EXPECT_EQ(json, "{}");
+    }
+}
+
+class NonEmptyHeapQueue : public ::testing::Test
+{
+protected:
+    virtual void SetUp() {
+        int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, 5, 55 };
+
+        for(int i = 0; i < 14; ++i)
+            queue.Insert(values[i]);
+    }
+
+    HeapPriorityQueue queue;
+};
+
+TEST_F(NonEmptyHeapQueue, Insert)
+{
+    queue.Insert(100);
+    EXPECT_EQ(queue.GetHead()->value, 100);
+
+    queue.Insert(0);
+    EXPECT_EQ(queue.GetHead()->value, 100);
+    EXPECT_EQ(queue.Length(), 16);
+}
+
+TEST_F(NonEmptyHeapQueue, RemoveAllForward)
+{
+    EXPECT_FALSE(queue.Remove(0));
+
+    int values[] = { 90, 85, 80, 70, 65, 60, 55, 50, 40, 30, 20, 15, 10, 5 };
+    for(int i = 0; i < 13; ++i)
+    {
+        EXPECT_TRUE(queue.Remove(values[i]));
+        EXPECT_EQ(queue.GetHead()->value, values[i + 1]);
+    }
+
+    queue.Remove(5);
+    EXPECT_TRUE(queue.GetHead() == NULL);
+    EXPECT_EQ(queue.Length(), 0);
+}
+
+TEST_F(NonEmptyHeapQueue, Find)
+{
+    int values[] = { 5, 10, 15, 20, 30, 40, 50, 55, 60, 65, 70, 80, 85, 90 };
+    for(int i = 0; i < 14; ++i)
+    {
+        HeapPriorityQueue::Element_t *pElem = queue.Find(values[i]);
+        ASSERT_TRUE(pElem != NULL);
+        EXPECT_EQ(pElem->value, values[i]);
+    }
+
+    EXPECT_TRUE(queue.Find(0) == NULL);
+}
+
+TEST_F(NonEmptyHeapQueue, MatchesLinkedList)
+{
+    PriorityQueue reference;
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, 5, 55 };
+
+    for(int i = 0; i < 14; ++i)
+        reference.Insert(values[i]);
+
+    //duplicates and removal from the middle
+    unsigned seed = 7;
+    for(int i = 0; i < 500; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int value = int(seed >> 16) % 64;
+
+        if(seed & 1)
+        {
+            queue.Insert(value);
+            reference.Insert(value);
+        }
+        else
+        {
+            EXPECT_EQ(queue.Remove(value), reference.Remove(value));
+        }
+
+        ASSERT_EQ(queue.Length(), reference.Length());
+        ASSERT_EQ(queue.GetHead() == NULL, reference.GetHead() == NULL);
+
+        if(queue.GetHead() != NULL)
+        {
+            EXPECT_EQ(queue.GetHead()->value, reference.GetHead()->value);
+        }
+    }
+}
+
+TEST_F(NonEmptyHeapQueue, Handles)
+{
+    HeapPriorityQueue::Handle_t low = queue.Insert(1);
+    HeapPriorityQueue::Handle_t dup = queue.Insert(1);
+
+    ASSERT_NE(low, dup);
+    EXPECT_EQ(queue.Get(low)->value, 1);
+
+    //increase key moves element to the top
+    EXPECT_TRUE(queue.UpdatePriority(low, 200));
+    EXPECT_EQ(queue.GetHead()->value, 200);
+    EXPECT_EQ(queue.Get(low), queue.GetHead());
+
+    //decrease key moves it back down
+    EXPECT_TRUE(queue.UpdatePriority(low, -5));
+    EXPECT_EQ(queue.GetHead()->value, 90);
+    EXPECT_EQ(queue.Get(low)->value, -5);
+
+    EXPECT_TRUE(queue.Erase(dup));
+    EXPECT_FALSE(queue.Erase(dup));
+    EXPECT_FALSE(queue.UpdatePriority(dup, 10));
+    EXPECT_TRUE(queue.Get(dup) == NULL);
+    EXPECT_FALSE(queue.Erase(HeapPriorityQueue::INVALID_HANDLE));
+    EXPECT_EQ(queue.Length(), 15);
+
+    //remaining handles follow elements moved by erase and pops
+    EXPECT_TRUE(queue.Remove(90));
+    EXPECT_TRUE(queue.Erase(low));
+    EXPECT_TRUE(queue.Find(-5) == NULL);
+    EXPECT_EQ(queue.Length(), 13);
+}
+
+TEST_F(NonEmptyHeapQueue, InsertMany)
+{
+    std::vector<int> batch;
+    std::vector<HeapPriorityQueue::Handle_t> handles(40);
+
+    //large batch rebuilds the heap, small one sifts up
+    for(int i = 0; i < 40; ++i)
+        batch.push_back((i * 37) % 101);
+
+    queue.InsertMany(batch.data(), 30, handles.data());
+    queue.InsertMany(batch.data() + 30, 10, handles.data() + 30);
+    EXPECT_EQ(queue.Length(), 54);
+
+    for(size_t i = 0; i < batch.size(); ++i)
+        EXPECT_EQ(queue.Get(handles[i])->value, batch[i]);
+
+    int previous = queue.GetHead()->value;
+    while(queue.GetHead() != NULL)
+    {
+        EXPECT_LE(queue.GetHead()->value, previous);
+        previous = queue.GetHead()->value;
+        queue.Remove(previous);
+    }
+}
+
+TEST_F(NonEmptyHeapQueue, PopTop)
+{
+    int value = 0;
+    int out[8];
+
+    EXPECT_TRUE(queue.PopTop(&value));
+    EXPECT_EQ(value, 90);
+
+    EXPECT_EQ(queue.PopTop(4, out), 4);
+    EXPECT_EQ(out[0], 85);
+    EXPECT_EQ(out[3], 65);
+
+    std::vector<int> drained;
+    EXPECT_EQ(queue.DrainWhile([](int v) { return v >= 40; }, drained), 4);
+    EXPECT_EQ(drained, std::vector<int>({ 60, 55, 50, 40 }));
+    EXPECT_EQ(queue.GetHead()->value, 30);
+
+    EXPECT_EQ(queue.PopTop(8, out), 5);
+    EXPECT_EQ(out[4], 5);
+    EXPECT_FALSE(queue.PopTop());
+}
+
+TEST(HeapQueueHandles, StaleHandleAfterReuse)
+{
+    HeapPriorityQueue queue;
+
+    HeapPriorityQueue::Handle_t timer = queue.Insert(10);
+    HeapPriorityQueue::Handle_t other = queue.Insert(20);
+
+    //cancel timer, its slot is reused by the next insert
+    EXPECT_TRUE(queue.Erase(timer));
+    HeapPriorityQueue::Handle_t reused = queue.Insert(30);
+
+    ASSERT_NE(reused, timer);
+
+    //stale handle must not touch the element now living in its slot
+    EXPECT_TRUE(queue.Get(timer) == NULL);
+    EXPECT_FALSE(queue.UpdatePriority(timer, 99));
+    EXPECT_FALSE(queue.Erase(timer));
+
+    EXPECT_EQ(queue.Length(), 2);
+    EXPECT_EQ(queue.Get(reused)->value, 30);
+    EXPECT_EQ(queue.Get(other)->value, 20);
+
+    //same holds after removal by PopTop and by value
+    EXPECT_TRUE(queue.PopTop());
+    EXPECT_TRUE(queue.Remove(20));
+    HeapPriorityQueue::Handle_t again = queue.Insert(5);
+
+    EXPECT_TRUE(queue.Get(reused) == NULL);
+    EXPECT_TRUE(queue.Get(other) == NULL);
+    EXPECT_FALSE(queue.Erase(reused));
+    EXPECT_EQ(queue.Get(again)->value, 5);
+}
+
+TEST(HeapQueueHandles, RandomUpdates)
+{
+    HeapPriorityQueue queue;
+    std::vector<HeapPriorityQueue::Handle_t> handles;
+    std::vector<int> values;
+
+    for(int i = 0; i < 200; ++i)
+    {
+        handles.push_back(queue.Insert(i));
+        values.push_back(i);
+    }
+
+    unsigned seed = 11;
+    for(int i = 0; i < 2000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        size_t k = (seed >> 8) % handles.size();
+        int value = int(seed >> 16) % 1000 - 500;
+
+        ASSERT_TRUE(queue.UpdatePriority(handles[k], value));
+        values[k] = value;
+
+        ASSERT_EQ(queue.GetHead()->value, *std::max_element(values.begin(), values.end()));
+    }
+
+    for(size_t k = 0; k < handles.size(); ++k)
+        EXPECT_EQ(queue.Get(handles[k])->value, values[k]);
+
+    for(size_t k = 0; k < handles.size(); ++k)
+        EXPECT_TRUE(queue.Erase(handles[k]));
+
+    EXPECT_TRUE(queue.GetHead() == NULL);
+}
+
+TEST(ConcurrentQueue, Sequential)
+{
+    ConcurrentPriorityQueue queue;
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, 5, 55, 55 };
+
+    EXPECT_FALSE(queue.PopTop());
+
+    for(int i = 0; i < 15; ++i)
+        queue.Insert(values[i]);
+
+    EXPECT_EQ(queue.Length(), 15);
+    EXPECT_TRUE(queue.Find(55));
+    EXPECT_TRUE(queue.Find(5));
+    EXPECT_FALSE(queue.Find(0));
+
+    int out[4];
+    EXPECT_EQ(queue.PopTop(4, out), 4);
+    EXPECT_EQ(out[0], 90);
+    EXPECT_EQ(out[3], 70);
+
+    int value = 0;
+    int sorted[] = { 65, 60, 55, 55, 50, 40, 30, 20, 15, 10, 5 };
+    for(int i = 0; i < 11; ++i)
+    {
+        ASSERT_TRUE(queue.PopTop(&value));
+        EXPECT_EQ(value, sorted[i]);
+    }
+
+    EXPECT_FALSE(queue.PopTop(&value));
+    EXPECT_FALSE(queue.Find(55));
+    EXPECT_EQ(queue.Length(), 0);
+}
+
+TEST(ConcurrentQueue, ParallelInsertPop)
+{
+    const int THREADS = 4;
+    const int PER_THREAD = 5000;
+
+    ConcurrentPriorityQueue queue;
+    std::vector<std::vector<int> > popped(THREADS);
+    std::vector<std::thread> threads;
+
+    //every thread inserts its own values and pops whatever is on top
+    for(int t = 0; t < THREADS; ++t)
+    {
+        threads.push_back(std::thread([&queue, &popped, t, PER_THREAD] {
+            int value;
+
+            for(int i = 0; i < PER_THREAD; ++i)
+            {
+                queue.Insert((i * 7919 + t) % 1000);
+
+                if(i % 2 == 1 && queue.PopTop(&value))
+                    popped[t].push_back(value);
+            }
+        }));
+    }
+
+    for(size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    std::vector<int> all;
+    for(int t = 0; t < THREADS; ++t)
+        all.insert(all.end(), popped[t].begin(), popped[t].end());
+
+    EXPECT_EQ(all.size() + queue.Length(), size_t(THREADS * PER_THREAD));
+
+    //rest comes out sorted
+    int value;
+    int previous = 1000;
+    while(queue.PopTop(&value))
+    {
+        EXPECT_LE(value, previous);
+        previous = value;
+        all.push_back(value);
+    }
+
+    std::vector<int> expected;
+    for(int t = 0; t < THREADS; ++t)
+        for(int i = 0; i < PER_THREAD; ++i)
+            expected.push_back((i * 7919 + t) % 1000);
+
+    std::sort(all.begin(), all.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(all, expected);
+}
+
+/**
+ * Fronta, jejiz polozky maji vysoke veze, pripojovani vyssich urovni se tak
+ * casto prekryva s odebranim stejne polozky.
+ */
+class TallTowerQueue : public ConcurrentPriorityQueue
+{
+public:
+    TallTowerQueue() : ConcurrentPriorityQueue(MAX_LEVEL - 4) {}
+};
+
+TEST(ConcurrentQueue, PopWhileLinkingTowers)
+{
+    const int THREADS = 4;
+    const int PER_THREAD = 20000;
+
+    TallTowerQueue queue;
+    std::vector<std::vector<int> > popped(THREADS);
+    std::vector<std::thread> threads;
+
+    //growing values land on top, pops race with the inserts still linking them
+    for(int t = 0; t < THREADS; ++t)
+    {
+        threads.push_back(std::thread([&queue, &popped, t, PER_THREAD] {
+            int value;
+
+            for(int i = 0; i < PER_THREAD; ++i)
+            {
+                queue.Insert(i * THREADS + t);
+
+                if(i % 4 != 3 && queue.PopTop(&value))
+                    popped[t].push_back(value);
+            }
+        }));
+    }
+
+    for(size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    std::vector<int> all;
+    for(int t = 0; t < THREADS; ++t)
+        all.insert(all.end(), popped[t].begin(), popped[t].end());
+
+    int value;
+    while(queue.PopTop(&value))
+        all.push_back(value);
+
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), size_t(THREADS * PER_THREAD));
+    for(size_t i = 0; i < all.size(); ++i)
+        ASSERT_EQ(all[i], int(i));
+}
+
+TEST(MultiQueueTest, SingleShardExact)
+{
+    MultiQueue queue(1, 1);
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, 5, 55 };
+
+    ASSERT_EQ(queue.Shards(), 1);
+    EXPECT_FALSE(queue.PopTop());
+
+    for(int i = 0; i < 14; ++i)
+        queue.Insert(values[i]);
+
+    EXPECT_EQ(queue.Length(), 14);
+
+    int out[14];
+    int sorted[] = { 90, 85, 80, 70, 65, 60, 55, 50, 40, 30, 20, 15, 10, 5 };
+
+    EXPECT_EQ(queue.PopTop(20, out), 14);
+    EXPECT_TRUE(std::equal(out, out + 14, sorted));
+    EXPECT_EQ(queue.Length(), 0);
+}
+
+TEST(MultiQueueTest, RankError)
+{
+    MultiQueue queue(4, 2);
+    std::vector<int> remaining;
+
+    for(int i = 0; i < 4000; ++i)
+    {
+        queue.Insert(i);
+        remaining.push_back(i);
+    }
+
+    //rank = number of larger elements still in the queue
+    double rankSum = 0;
+    int value;
+    while(queue.PopTop(&value))
+    {
+        std::vector<int>::iterator it = std::lower_bound(remaining.begin(), remaining.end(), value);
+        ASSERT_TRUE(it != remaining.end() && *it == value);
+
+        rankSum += double(remaining.end() - it - 1);
+        remaining.erase(it);
+    }
+
+    EXPECT_TRUE(remaining.empty());
+    EXPECT_LT(rankSum / 4000, 2.0 * queue.Shards());
+}
+
+TEST(MultiQueueTest, ParallelInsertPop)
+{
+    const int THREADS = 4;
+    const int PER_THREAD = 5000;
+
+    MultiQueue queue(THREADS);
+    std::vector<std::vector<int> > popped(THREADS);
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < THREADS; ++t)
+    {
+        threads.push_back(std::thread([&queue, &popped, t, PER_THREAD] {
+            int value;
+
+            for(int i = 0; i < PER_THREAD; ++i)
+            {
+                queue.Insert(i * THREADS + t);
+
+                if(i % 2 == 1 && queue.PopTop(&value))
+                    popped[t].push_back(value);
+            }
+        }));
+    }
+
+    for(size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    std::vector<int> all;
+    for(int t = 0; t < THREADS; ++t)
+        all.insert(all.end(), popped[t].begin(), popped[t].end());
+
+    int value;
+    while(queue.PopTop(&value))
+        all.push_back(value);
+
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), size_t(THREADS * PER_THREAD));
+
+    for(int i = 0; i < THREADS * PER_THREAD; ++i)
+        EXPECT_EQ(all[i], i);
+}
+
+TEST(RadixHeapTest, Monotone)
+{
+    RadixHeap heap;
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, -5, 55, 55 };
+
+    EXPECT_FALSE(heap.PopTop());
+
+    for(int i = 0; i < 15; ++i)
+        EXPECT_TRUE(heap.Insert(values[i]));
+
+    int value = 0;
+    EXPECT_TRUE(heap.PopTop(&value));
+    EXPECT_EQ(value, 90);
+    EXPECT_EQ(heap.Limit(), 90);
+
+    //monotone: nothing above last popped value
+    EXPECT_FALSE(heap.Insert(91));
+    EXPECT_TRUE(heap.Insert(90));
+    EXPECT_TRUE(heap.Insert(62));
+
+    int out[16];
+    int sorted[] = { 90, 85, 80, 70, 65, 62, 60, 55, 55, 50, 40, 30, 20, 15, 10, -5 };
+
+    EXPECT_EQ(heap.Length(), 16);
+    EXPECT_EQ(heap.PopTop(20, out), 16);
+    EXPECT_TRUE(std::equal(out, out + 16, sorted));
+    EXPECT_EQ(heap.Length(), 0);
+}
+
+TEST(RadixHeapTest, DijkstraLikeWorkload)
+{
+    RadixHeap heap;
+    HeapPriorityQueue reference;
+
+    EXPECT_TRUE(heap.Insert(0));
+    reference.Insert(0);
+
+    //every popped key produces keys at most as large, like relaxed edges
+    unsigned seed = 3;
+    int value;
+    while(heap.PopTop(&value))
+    {
+        ASSERT_TRUE(reference.GetHead() != NULL);
+        ASSERT_EQ(value, reference.GetHead()->value);
+        reference.PopTop();
+
+        for(int i = 0; i < 2 && value > -100000; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            int next = value - int((seed >> 16) % 5000);
+
+            EXPECT_TRUE(heap.Insert(next));
+            reference.Insert(next);
+        }
+
+        if(heap.Length() > 2000)
+            break;
+    }
+
+    EXPECT_EQ(heap.Length(), reference.Length());
+}
+
+TEST(BucketQueueTest, Range)
+{
+    BucketQueue queue(-10, 200);
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, -10, 200, 55, 55 };
+
+    EXPECT_ANY_THROW(BucketQueue(5, 4));
+    EXPECT_FALSE(queue.PopTop());
+    EXPECT_FALSE(queue.Insert(201));
+    EXPECT_FALSE(queue.Insert(-11));
+
+    for(int i = 0; i < 16; ++i)
+        EXPECT_TRUE(queue.Insert(values[i]));
+
+    EXPECT_EQ(queue.Find(55), 2);
+    EXPECT_EQ(queue.Find(56), 0);
+    EXPECT_TRUE(queue.Remove(200));
+    EXPECT_FALSE(queue.Remove(200));
+    EXPECT_TRUE(queue.Remove(55));
+
+    int out[16];
+    int sorted[] = { 90, 85, 80, 70, 65, 60, 55, 50, 40, 30, 20, 15, 10, -10 };
+
+    EXPECT_EQ(queue.Length(), 14);
+    EXPECT_EQ(queue.PopTop(20, out), 14);
+    EXPECT_TRUE(std::equal(out, out + 14, sorted));
+
+    //top follows inserts after drain
+    EXPECT_TRUE(queue.Insert(3));
+    EXPECT_TRUE(queue.Insert(150));
+    int value = 0;
+    EXPECT_TRUE(queue.PopTop(&value));
+    EXPECT_EQ(value, 150);
+}
+
+template <unsigned Arity>
+static void CompareDaryHeap()
+{
+    DaryHeap<Arity> heap;
+    HeapPriorityQueue reference;
+
+    EXPECT_TRUE(heap.Top() == NULL);
+    EXPECT_FALSE(heap.PopTop());
+
+    //random insert/pop mix including INT_MIN and duplicates
+    unsigned seed = Arity;
+    int value;
+    for(int i = 0; i < 5000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        if((seed >> 8) % 3 != 0)
+        {
+            int next = (seed & 0x10000) ? int(seed >> 16) % 500 : INT_MIN + int(seed >> 28);
+
+            heap.Insert(next);
+            reference.Insert(next);
+        }
+        else
+        {
+            EXPECT_EQ(heap.PopTop(&value), reference.PopTop());
+        }
+
+        ASSERT_EQ(heap.Length(), reference.Length());
+        if(reference.GetHead() != NULL)
+        {
+            ASSERT_EQ(*heap.Top(), reference.GetHead()->value);
+        }
+    }
+
+    while(heap.PopTop(&value))
+    {
+        ASSERT_EQ(value, reference.GetHead()->value);
+        reference.PopTop();
+    }
+
+    EXPECT_EQ(reference.Length(), 0);
+}
+
+TEST(DaryHeapTest, MatchesBinaryHeap)
+{
+    CompareDaryHeap<2>();
+    CompareDaryHeap<4>();
+    CompareDaryHeap<8>();
+}
+
+TEST(DaryHeapTest, PopTopBatch)
+{
+    QuaternaryHeap heap;
+    int values[] = { 10, 85, 15, 70, 20, 60, 30, 50, 65, 80, 90, 40, 5, 55 };
+
+    heap.Reserve(1000);
+    for(int i = 0; i < 14; ++i)
+        heap.Insert(values[i]);
+
+    int out[14];
+    int sorted[] = { 90, 85, 80, 70, 65, 60, 55, 50, 40, 30, 20, 15, 10, 5 };
+
+    EXPECT_EQ(heap.PopTop(20, out), 14);
+    EXPECT_TRUE(std::equal(out, out + 14, sorted));
+}
+
+TEST(DaryHeapTest, AlignedAllocationsTracked)
+{
+    AllocTracker tracker;
+    size_t allocations = 0;
+
+    {
+        QuaternaryHeap heap;
+
+        //reserve and growths go through aligned operator new
+        heap.Reserve(16);
+        EXPECT_EQ(tracker.allocations(), 1);
+
+        for(int i = 0; i < 100; ++i)
+            heap.Insert(i);
+
+        allocations = tracker.allocations();
+        tracker.restart();
+    }
+
+    EXPECT_GT(allocations, 1u);
+    EXPECT_EQ(tracker.deallocations(), 1);
+}
+
 /*** Konec souboru tdd_tests.cpp ***/
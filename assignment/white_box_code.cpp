@@ -13,134 +13,378 @@
  * @brief Definice metod tridy reprezentujici matici.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <stdexcept>
 
 #include "white_box_code.h"
+#include "lu_decomposition.h"
+#include "task_scheduler.h"
+#include "instrumentation.h"
 
-Matrix::Matrix(): mRows(1), mCols(1)
+/**
+ * @brief      LU dekompozice matice radu n v pracovnim typu prvku
+ *
+ * @param      matrix  prvky matice n x n ulozene po radcich
+ * @param      n       rad matice
+ *
+ * @return     Vrati dekompozici PA = LU
+ */
+template <typename T>
+static BlockedLU<typename MatrixTraits<T>::WorkType> luFactorize(const T *matrix, size_t n)
+{
+    typedef typename MatrixTraits<T>::WorkType W;
+    
+    std::vector<W> values(matrix, matrix + n * n);
+    
+    return BlockedLU<W>(values.data(), n);
+}
+
+/**
+ * Velikost dlazdice pri nasobeni matic
+ */
+static const size_t MULTIPLY_TILE = 64;
+
+/**
+ * Druh dlazdice pri nasobeni matic
+ */
+enum TileKind_t
+{
+    TILE_DENSE = 0,         ///< Obsahuje nenulove konecne prvky.
+    TILE_ZERO = 1,          ///< Pouze nulove prvky.
+    TILE_NONFINITE = 2      ///< Obsahuje Inf nebo NaN.
+};
+
+/**
+ * @brief      classifyTiles
+ *        * roztridi dlazdice tile x tile na nulove, nekonecne (Inf/NaN) a
+ *          ostatni, x - x je nenulove (NaN) prave pro Inf a NaN, u celociselnych
+ *          typu tak zadna dlazdice nekonecna neni
+ *
+ * @param      values  prvky matice ulozene po radcich
+ * @param      rows    pocet radku
+ * @param      cols    pocet sloupcu
+ * @param      tiles   vystup, TileKind_t kazde dlazdice (po radcich dlazdic),
+ *                     kapacita pole se znovu pouziva
+ */
+template <typename T>
+static void classifyTiles(const T *values, size_t rows, size_t cols, std::vector<char> &tiles)
+{
+    size_t tileCols = (cols + MULTIPLY_TILE - 1) / MULTIPLY_TILE;
+    tiles.assign(((rows + MULTIPLY_TILE - 1) / MULTIPLY_TILE) * tileCols, TILE_ZERO);
+    
+    for(size_t r = 0; r < rows; r++)
+    {
+        const T *rowValues = values + r * cols;
+        char *tileRow = &tiles[(r / MULTIPLY_TILE) * tileCols];
+        
+        for(size_t t = 0; t < tileCols; t++)
+        {
+            if(tileRow[t] == TILE_NONFINITE)
+                continue;
+            
+            size_t last = std::min((t + 1) * MULTIPLY_TILE, cols);
+            bool nonZero = false;
+            bool nonFinite = false;
+            
+            for(size_t c = t * MULTIPLY_TILE; c < last; c++)
+            {
+                nonZero |= rowValues[c] != T(0);
+                nonFinite |= rowValues[c] - rowValues[c] != T(0);
+            }
+            
+            if(nonFinite)
+                tileRow[t] = TILE_NONFINITE;
+            else if(nonZero)
+                tileRow[t] = TILE_DENSE;
+        }
+    }
+}
+
+/**
+ * Nejmensi pocet prvku matice pro paralelni operace po prvcich
+ */
+static std::atomic<size_t> g_parallelThreshold(1 << 18);
+
+/**
+ * Pocet prvku porovnanych mezi kontrolami priznaku nalezene rozdilnosti
+ */
+static const size_t COMPARE_CHUNK = 4096;
+
+/**
+ * @brief      forEachRange
+ *        * zavola fn(first, last) pro useky prvku [0, count), velke matice
+ *          deli staticky pres TaskScheduler::parallelFor, stejny pocet prvku
+ *          tak vzdy zpracuji stejna vlakna (a jejich NUMA uzly)
+ *
+ * @param      count   pocet prvku
+ * @param      fn      funkce volana pro kazdy usek
+ */
+template <typename F>
+static void forEachRange(size_t count, const F &fn)
+{
+    if(count < g_parallelThreshold.load(std::memory_order_relaxed))
+    {
+        fn(0, count);
+        return;
+    }
+    
+    TaskScheduler::instance().parallelFor(count, fn);
+}
+
+/**
+ * @brief      zeroFill
+ *        * vynuluje prvky matice, velke matice paralelne, prvni zapis do
+ *          stranek useku tak provede vlakno, ktere s nim pracuje i v
+ *          ostatnich operacich po prvcich
+ *
+ * @param      values  prvky matice ulozene po radcich
+ * @param      count   pocet prvku
+ */
+template <typename T>
+static void zeroFill(T *values, size_t count)
 {
-    matrix = std::vector<std::vector< double > >(1, std::vector<double>(1, 0));
+    forEachRange(count, [values](size_t first, size_t last) {
+        std::fill(values + first, values + last, T(0));
+    });
 }
 
-Matrix::Matrix(size_t row, size_t col): mRows(row), mCols(col)
+/**
+ * @brief      isNarrowBand
+ *
+ * @return     true pokud pas zabira nejvyse ctvrtinu radu matice
+ */
+static bool isNarrowBand(size_t n, size_t kl, size_t ku)
+{
+    return (kl + ku + 1) * 4 <= n;
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(): mRows(1), mCols(1)
+{
+    matrix.assign(1, T(0));
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t row, size_t col): mRows(row), mCols(col)
 {
     if(row < 1 || col < 1)
         throw std::runtime_error("Minimalni velikost matice je 1x1");
     
-    matrix = std::vector<std::vector< double > >(row, std::vector<double>(col, 0));
+    matrix.resize(row * col);
+    zeroFill(matrix.data(), matrix.size());
 }
 
-Matrix::~Matrix()
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t row, size_t col, Storage_t &&values): mRows(row), mCols(col)
+{
+    if(row < 1 || col < 1)
+        throw std::runtime_error("Minimalni velikost matice je 1x1");
+    
+    if(values.size() != row * col)
+        throw std::runtime_error("Pocet prvku neodpovida velikosti matice.");
+    
+    matrix.swap(values);
+}
+
+template <typename T>
+BasicMatrix<T>::~BasicMatrix()
 {
 
 }
 
-bool Matrix::set(size_t row, size_t col, double value)
+template <typename T>
+bool BasicMatrix<T>::set(size_t row, size_t col, T value)
 {
     if(!checkIndexes(row, col))
         return false;
     
-    matrix[row][col] = value;
+    (*this)(row, col) = value;
     
     return true;
 }
 
-bool Matrix::set(std::vector<std::vector< double > > values)
+template <typename T>
+bool BasicMatrix<T>::set(std::vector<std::vector< T > > values)
 {
-    bool fit = true;
-
-    if(matrix.size() != values.size())
+    if(values.size() != mRows)
     {
-        fit = false;
+        return false;
     }
 
-    for(int r = 0; r < matrix.size(); r++)
+    for(size_t r = 0; r < mRows; r++)
     {
-        if(values[r].size() != matrix[r].size())
+        if(values[r].size() != mCols)
         {
-            fit = false;
+            return false;
         }
     }
-
-    if(!fit)
-    {
-        return fit;
-    }
     
-    for(int r = 0; r < matrix.size(); r++)
+    for(size_t r = 0; r < mRows; r++)
     {
-        for(int c = 0; c < matrix[0].size(); c++)
-        {
-            matrix[r][c] = values[r][c];
-        }
+        std::copy(values[r].begin(), values[r].end(), row(r));
     }
     
     return true;
 }
 
-double Matrix::get(size_t row, size_t col)
+template <typename T>
+T BasicMatrix<T>::get(size_t row, size_t col)
 {
     if(!checkIndexes(row, col))
         throw std::runtime_error("Pristup k indexu mimo matici");
 
-    return matrix[row][col];
+    return (*this)(row, col);
 }
 
-bool Matrix::operator==(const Matrix m) const
+template <typename T>
+bool BasicMatrix<T>::operator==(const BasicMatrix &m) const
 {
     if(!checkEqualSize(m))
         throw std::runtime_error("Matice musi mit stejnou velikost.");
     
-    for(int r = 0; r < matrix.size(); r++)
-    {
-        for (int c = 0; c < matrix[r].size(); c++)
+    const T *a = data();
+    const T *b = m.data();
+    std::atomic<bool> differs(false);
+    
+    forEachRange(matrix.size(), [a, b, &differs](size_t first, size_t last) {
+        for(size_t i = first; i < last && !differs.load(std::memory_order_relaxed); i += COMPARE_CHUNK)
         {
-            if(matrix[r][c] != m.matrix[r][c])
-                return false;
+            size_t end = std::min(i + COMPARE_CHUNK, last);
+            
+            if(!std::equal(a + i, a + end, b + i))
+                differs.store(true, std::memory_order_relaxed);
         }
-    }
+    });
     
-    return true;
+    return !differs.load();
 }
 
-Matrix Matrix::operator+(const Matrix m) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix &m) const
 {
+    IVS_TRACE_SCOPE("Matrix::operator+");
+    
     if(!checkEqualSize(m))
         throw std::runtime_error("Matice musi mit stejnou velikost.");
     
-    Matrix result = Matrix(matrix.size(), matrix[0].size());
+    BasicMatrix result = BasicMatrix(mRows, mCols);
     
-    for(int r = 0; r < matrix.size(); r++)
-    {
-        for(int c = 0; c < matrix[r].size(); c++)
+    IVS_TRACE_FLOPS(matrix.size());
+    IVS_TRACE_BYTES(3 * matrix.size() * sizeof(T));
+    
+    const T *a = data();
+    const T *b = m.data();
+    T *res = result.data();
+    
+    forEachRange(matrix.size(), [a, b, res](size_t first, size_t last) {
+        for(size_t i = first; i < last; i++)
         {
-            result.set(r, c, matrix[r][c] + m.matrix[r][c]);
+            res[i] = a[i] + b[i];
         }
-    }
+    });
     
     return result;
 }
 
 
-Matrix Matrix::operator*(const Matrix m) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix &m) const
 {
-    if(matrix[0].size() == m.matrix.size())
+    IVS_TRACE_SCOPE("Matrix::operator*");
+    
+    BasicMatrix result = BasicMatrix(mRows, m.mCols);
+    
+    multiplyInto(m, result);
+    
+    return result;
+}
+
+template <typename T>
+void BasicMatrix<T>::multiplyInto(const BasicMatrix &m, BasicMatrix &result) const
+{
+    IVS_TRACE_SCOPE("Matrix::multiplyInto");
+    
+    if(&result == this || &result == &m)
+        throw std::runtime_error("Vysledek nasobeni nesmi byt zaroven cinitelem.");
+    
+    if(mCols == m.mRows)
     {
-        Matrix result = Matrix(matrix.size(), m.matrix[0].size());
+        result.resize(mRows, m.mCols);
+        
+        // nominalni pocet operaci, bez preskocenych nulovych dlazdic
+        IVS_TRACE_FLOPS(2 * mRows * mCols * m.mCols);
+        IVS_TRACE_BYTES((matrix.size() + m.matrix.size() + result.matrix.size()) * sizeof(T));
         
-        for(int r = 0; r < matrix.size(); r++)
+        // nulove dlazdice obou cinitelu se preskakuji cele, u blokove
+        // diagonalnich a trojuhelnikovych matic tak odpada vetsina prace;
+        // nula se preskoci jen proti konecnym prvkum, 0 * Inf a 0 * NaN tak
+        // dale dava NaN
+        static thread_local std::vector<char> aTiles;
+        static thread_local std::vector<char> bTiles;
+        static thread_local std::vector<char> bBandNonFinite;
+        
+        classifyTiles(data(), mRows, mCols, aTiles);
+        classifyTiles(m.data(), m.mRows, m.mCols, bTiles);
+        size_t aTileCols = (mCols + MULTIPLY_TILE - 1) / MULTIPLY_TILE;
+        size_t bTileCols = (m.mCols + MULTIPLY_TILE - 1) / MULTIPLY_TILE;
+        
+        // pas radku druheho cinitele s Inf/NaN, proti nemu nelze preskocit nulovou dlazdici
+        bBandNonFinite.assign(aTileCols, 0);
+        for(size_t t = 0; t < bTiles.size(); t++)
         {
-            for(int c = 0; c < m.matrix[0].size(); c++)
+            if(bTiles[t] == TILE_NONFINITE)
+                bBandNonFinite[t / bTileCols] = 1;
+        }
+        
+        for(size_t r0 = 0; r0 < mRows; r0 += MULTIPLY_TILE)
+        {
+            size_t r1 = std::min(r0 + MULTIPLY_TILE, mRows);
+            
+            for(size_t i0 = 0; i0 < mCols; i0 += MULTIPLY_TILE)
             {
-                for(int i = 0; i < matrix[r].size(); i++)
+                size_t i1 = std::min(i0 + MULTIPLY_TILE, mCols);
+                char aTile = aTiles[(r0 / MULTIPLY_TILE) * aTileCols + i0 / MULTIPLY_TILE];
+                
+                if(aTile == TILE_ZERO && !bBandNonFinite[i0 / MULTIPLY_TILE])
+                    continue;
+                
+                for(size_t c0 = 0; c0 < m.mCols; c0 += MULTIPLY_TILE)
                 {
-                    result.set(r, c, result.get(r, c) +  matrix[r][i] * m.matrix[i][c]);
+                    size_t c1 = std::min(c0 + MULTIPLY_TILE, m.mCols);
+                    char bTile = bTiles[(i0 / MULTIPLY_TILE) * bTileCols + c0 / MULTIPLY_TILE];
+                    
+                    if(bTile == TILE_ZERO && aTile != TILE_NONFINITE)
+                        continue;
+                    
+                    const bool skipZero = bTile != TILE_NONFINITE;
+                    
+                    // poradi r-i-c prochazi oba radky souvisle, vnitrni smycka se tak
+                    // pro kazdy typ prvku vektorizuje na plnou sirku SIMD registru
+                    for(size_t r = r0; r < r1; r++)
+                    {
+                        T *resultRow = result.row(r);
+                        const T *aRow = row(r);
+                        
+                        for(size_t i = i0; i < i1; i++)
+                        {
+                            const T a = aRow[i];
+                            
+                            if(skipZero && a == T(0))
+                                continue;
+                            
+                            const T *mRow = m.row(i);
+                            
+                            for(size_t c = c0; c < c1; c++)
+                            {
+                                resultRow[c] += a * mRow[c];
+                            }
+                        }
+                    }
                 }
             }
         }
-        
-        return result;
     }
     else
     {
@@ -148,224 +392,898 @@ Matrix Matrix::operator*(const Matrix m) const
     }
 }
 
-Matrix Matrix::operator*(const double value) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::pow(unsigned k) const
 {
-    Matrix result = Matrix(matrix.size(), matrix[0].size());
-  
-    for(int r = 0; r < matrix.size(); r++)
+    if(mRows != mCols)
+        throw std::runtime_error("Matice musi byt ctvercova.");
+    
+    BasicMatrix result(mRows, mCols);
+    
+    if(k == 0)
     {
-        for(int c = 0; c < matrix[r].size(); c++)
+        for(size_t i = 0; i < mRows; i++)
+            result(i, i) = T(1);
+        
+        return result;
+    }
+    
+    // umocnovani ctvercem, mezivysledky se stridaji se dvema pomocnymi
+    // maticemi, ktere se alokuji jen jednou
+    BasicMatrix base = *this;
+    BasicMatrix scratch(mRows, mCols);
+    bool first = true;
+    
+    while(k > 0)
+    {
+        if(k & 1)
         {
-            result.set(r, c, matrix[r][c] * value);
+            if(first)
+            {
+                result.matrix = base.matrix;
+                first = false;
+            }
+            else
+            {
+                result.multiplyInto(base, scratch);
+                result.swap(scratch);
+            }
+        }
+        
+        k >>= 1;
+        
+        if(k > 0)
+        {
+            base.multiplyInto(base, scratch);
+            base.swap(scratch);
         }
     }
     
     return result;
 }
 
-std::vector<double> Matrix::solveEquation(std::vector<double> b)
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const T value) const
+{
+    IVS_TRACE_SCOPE("Matrix::operator*(scalar)");
+    IVS_TRACE_FLOPS(matrix.size());
+    IVS_TRACE_BYTES(2 * matrix.size() * sizeof(T));
+    
+    BasicMatrix result = BasicMatrix(mRows, mCols);
+    
+    const T *a = data();
+    T *res = result.data();
+    
+    forEachRange(matrix.size(), [a, res, value](size_t first, size_t last) {
+        for(size_t i = first; i < last; i++)
+        {
+            res[i] = a[i] * value;
+        }
+    });
+    
+    return result;
+}
+
+/**
+ * @brief      gemvRows
+ *        * y[first..last) = A[first..last) * x, ctyri radky najednou sdili
+ *          cteni x a davaji ctyri nezavisle soucty
+ */
+template <typename T>
+static void gemvRows(const T *a, size_t cols, const T *x, T *y, size_t first, size_t last)
+{
+    size_t r = first;
+    
+    for(; r + 4 <= last; r += 4)
+    {
+        const T *a0 = a + r * cols;
+        const T *a1 = a0 + cols;
+        const T *a2 = a1 + cols;
+        const T *a3 = a2 + cols;
+        T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+        
+        for(size_t c = 0; c < cols; c++)
+        {
+            const T xc = x[c];
+            
+            s0 += a0[c] * xc;
+            s1 += a1[c] * xc;
+            s2 += a2[c] * xc;
+            s3 += a3[c] * xc;
+        }
+        
+        y[r] = s0;
+        y[r + 1] = s1;
+        y[r + 2] = s2;
+        y[r + 3] = s3;
+    }
+    
+    // zbyvajici radky se stejnym poradim scitani jako hlavni smycka,
+    // vysledek radku tak nezavisi na jeho poloze v bloku
+    for(; r < last; r++)
+    {
+        const T *ar = a + r * cols;
+        T s = T(0);
+        
+        for(size_t c = 0; c < cols; c++)
+            s += ar[c] * x[c];
+        
+        y[r] = s;
+    }
+}
+
+/**
+ * @brief      gemvTransposedCols
+ *        * y[first..last) = (A^T * x)[first..last), radky A se pricitaji po
+ *          ctyrech, vnitrni smycka je souvisla a vektorizuje se
+ */
+template <typename T>
+static void gemvTransposedCols(const T *a, size_t rows, size_t cols, const T *x, T *y,
+                               size_t first, size_t last)
+{
+    std::fill(y + first, y + last, T(0));
+    
+    size_t r = 0;
+    
+    for(; r + 4 <= rows; r += 4)
+    {
+        const T *a0 = a + r * cols;
+        const T *a1 = a0 + cols;
+        const T *a2 = a1 + cols;
+        const T *a3 = a2 + cols;
+        const T x0 = x[r], x1 = x[r + 1], x2 = x[r + 2], x3 = x[r + 3];
+        
+        for(size_t c = first; c < last; c++)
+        {
+            y[c] += a0[c] * x0 + a1[c] * x1 + a2[c] * x2 + a3[c] * x3;
+        }
+    }
+    
+    for(; r < rows; r++)
+    {
+        const T *ar = a + r * cols;
+        const T xr = x[r];
+        
+        for(size_t c = first; c < last; c++)
+        {
+            y[c] += ar[c] * xr;
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> BasicMatrix<T>::operator*(const std::vector<T> &x) const
+{
+    if(x.size() != mCols)
+        throw std::runtime_error("Pocet prvku vektoru musi odpovidat poctu sloupcu matice.");
+    
+    std::vector<T> y(mRows);
+    multiplyVector(x.data(), y.data());
+    
+    return y;
+}
+
+template <typename T>
+void BasicMatrix<T>::multiplyVector(const T *x, T *y) const
+{
+    IVS_TRACE_SCOPE("Matrix::multiplyVector");
+    IVS_TRACE_FLOPS(2 * matrix.size());
+    IVS_TRACE_BYTES((matrix.size() + mRows + mCols) * sizeof(T));
+    
+    const T *a = data();
+    size_t cols = mCols;
+    
+    if(matrix.size() < g_parallelThreshold.load(std::memory_order_relaxed))
+    {
+        gemvRows(a, cols, x, y, 0, mRows);
+        return;
+    }
+    
+    TaskScheduler::instance().parallelFor(mRows, [a, cols, x, y](size_t first, size_t last) {
+        gemvRows(a, cols, x, y, first, last);
+    });
+}
+
+template <typename T>
+std::vector<T> BasicMatrix<T>::multiplyTransposed(const std::vector<T> &x) const
 {
-    std::vector<double> res = std::vector<double>(matrix.size(), 0);
+    if(x.size() != mRows)
+        throw std::runtime_error("Pocet prvku vektoru musi odpovidat poctu radku matice.");
+    
+    std::vector<T> y(mCols);
+    multiplyTransposedVector(x.data(), y.data());
+    
+    return y;
+}
+
+template <typename T>
+void BasicMatrix<T>::multiplyTransposedVector(const T *x, T *y) const
+{
+    IVS_TRACE_SCOPE("Matrix::multiplyTransposedVector");
+    IVS_TRACE_FLOPS(2 * matrix.size());
+    IVS_TRACE_BYTES((matrix.size() + mRows + mCols) * sizeof(T));
+    
+    const T *a = data();
+    size_t rows = mRows;
+    size_t cols = mCols;
     
-    std::vector<std::vector<double> > temp = 
-        std::vector<std::vector< double > >(matrix.size(), std::vector<double>(matrix.size(), 0));
+    if(matrix.size() < g_parallelThreshold.load(std::memory_order_relaxed))
+    {
+        gemvTransposedCols(a, rows, cols, x, y, 0, cols);
+        return;
+    }
+    
+    TaskScheduler::instance().parallelFor(cols, [a, rows, cols, x, y](size_t first, size_t last) {
+        gemvTransposedCols(a, rows, cols, x, y, first, last);
+    });
+}
+
+template <typename T>
+std::vector<T> BasicMatrix<T>::solveEquation(std::vector<T> b)
+{
+    IVS_TRACE_SCOPE("Matrix::solveEquation");
+    IVS_TRACE_BYTES((matrix.size() + 2 * b.size()) * sizeof(T));
+    
+    std::vector<T> res = std::vector<T>(mRows, T(0));
         
-    if(matrix[0].size() != b.size())
+    if(mCols != b.size())
         throw std::runtime_error("Pocet prvku prave strany rovnice musi odpovidat poctu radku matice.");
     
     if(!checkSquare())
         throw std::runtime_error("Matice musi byt ctvercova.");
+    
+    size_t kl = lowerBandwidth();
+    size_t ku = upperBandwidth();
+    
+    if(kl == 0 || ku == 0 || isNarrowBand(mRows, kl, ku))
+    {
+        IVS_TRACE_FLOPS(2 * mRows * (kl + 1) * (kl + ku + 1));
+        return solveBanded(b, kl, ku);
+    }
+    
+    if(mRows > 3)
+    {
+        typedef typename MatrixTraits<T>::WorkType W;
+        
+        IVS_TRACE_FLOPS(2 * mRows * mRows * mRows / 3 + 2 * mRows * mRows);
+        
+        BlockedLU<W> lu = luFactorize(matrix.data(), mRows);
+        
+        if(lu.isSingular())
+            throw std::runtime_error("Matice je singularni.");
+        
+        std::vector<W> x(b.begin(), b.end());
+        lu.solve(x.data());
+        
+        for(size_t i = 0; i < x.size(); i++)
+            res[i] = MatrixTraits<T>::fromWork(x[i]);
+        
+        return res;
+    }
   
-    double determinatAll = determinant();
+    T determinatAll = determinant();
   
-    if(abs(determinatAll) < std::numeric_limits<double>::epsilon())
+    if(MatrixTraits<T>::isZero(determinatAll))
         throw std::runtime_error("Matice je singularni.");
     
-    for(int i = 0; i < matrix.size(); i++)
-    {
-        for(int j = 0; j < matrix[i].size(); j++)
-        {
-            temp[i][j] = matrix[i][j];
-        }
-    }
+    std::vector<T> temp(matrix.begin(), matrix.end());
     
-    for(int i = 0; i < matrix.size(); i++)
+    for(size_t i = 0; i < mRows; i++)
     {
-        for(int k = 0; k < matrix[i].size(); k++)
+        for(size_t k = 0; k < mRows; k++)
         {
-            temp[k][i] = b[k];
+            temp[k * mCols + i] = b[k];
         }
         
-        res[i] = deter(temp, temp.size())/determinatAll;
+        res[i] = deter(temp.data(), mRows)/determinatAll;
         
-        for(int k = 0; k < matrix[i].size(); k++)
-            temp[k][i] = matrix[k][i];
+        for(size_t k = 0; k < mRows; k++)
+            temp[k * mCols + i] = (*this)(k, i);
     }
     
     return res;
 }
 
-bool Matrix::checkIndexes(size_t row, size_t col)
+template <typename T>
+bool BasicMatrix<T>::checkIndexes(size_t row, size_t col)
 {
-    if(row >= matrix.size() || col >=  matrix[0].size())
+    if(row >= mRows || col >= mCols)
         return false;
   
     return true;
 }
 
-bool Matrix::checkSquare()
+template <typename T>
+bool BasicMatrix<T>::checkSquare()
 {
-    if(matrix.size() == matrix[0].size())
+    if(mRows == mCols)
         return true;
     
     return false;
 }
 
-bool Matrix::checkEqualSize(const Matrix m) const
+template <typename T>
+bool BasicMatrix<T>::checkEqualSize(const BasicMatrix &m) const
 {
-    if(m.matrix.size() == matrix.size() && m.matrix[0].size() ==  matrix[0].size())
+    if(m.mRows == mRows && m.mCols == mCols)
         return true;
     
     return false;
 }
 
-double Matrix::determinant()
+template <typename T>
+T BasicMatrix<T>::determinant()
 {
-    if(matrix.size() == 1)
-    {
-        return matrix[0][0];
-    }
-    else if(matrix.size() == 2)
-    {
-        return matrix[0][0]*matrix[1][1] - matrix[1][0]*matrix[0][1];
-    }
-    else if(matrix.size() == 3)
-    {
-        return matrix[0][0]*matrix[1][1]*matrix[2][2] +
-            matrix[0][1]*matrix[1][2]*matrix[2][0] + 
-            matrix[0][2]*matrix[1][0]*matrix[2][1] - 
-            matrix[2][0]*matrix[1][1]*matrix[0][2] - 
-            matrix[2][1]*matrix[1][2]*matrix[0][0] - 
-            matrix[2][2]*matrix[0][1]*matrix[1][0];
+    IVS_TRACE_SCOPE("Matrix::determinant");
+    IVS_TRACE_BYTES(matrix.size() * sizeof(T));
     
-    }
-    else
+    if(mRows > 3)
     {
-        return deter(matrix, matrix.size());
+        if(lowerBandwidth() == 0 || upperBandwidth() == 0)
+        {
+            T det = T(1);
+            
+            IVS_TRACE_FLOPS(mRows);
+            
+            for(size_t i = 0; i < mRows; i++)
+                det *= (*this)(i, i);
+            
+            return det;
+        }
+        
+        IVS_TRACE_FLOPS(2 * mRows * mRows * mRows / 3);
+        
+        return MatrixTraits<T>::fromWork(luFactorize(matrix.data(), mRows).determinant());
     }
+    
+    return deter(matrix.data(), mRows);
 }
 
 
-std::vector< std::vector<double> > getMinimo( std::vector< std::vector<double> > src, int I, int J, int ordSrc )
+template <typename T>
+static std::vector<T> getMinimo( const T *src, size_t I, size_t J, size_t ordSrc )
 {
-    std::vector< std::vector<double> > minimo( ordSrc-1, std::vector<double> (ordSrc-1,0));
+    std::vector<T> minimo( (ordSrc-1) * (ordSrc-1), T(0));
 
-    int rowCont = 0;
+    size_t k = 0;
     
-    for(int i=0; i < ordSrc; i++)
+    for(size_t i=0; i < ordSrc; i++)
     {
-        int colCont = 0;
-        
         if(i != I)
         {
-            for(int j=0; j < ordSrc; j++)
+            for(size_t j=0; j < ordSrc; j++)
             {
                 if(j != J)
                 {
-                    minimo[rowCont][colCont] = src[i][j];
-                    colCont++; 
+                    minimo[k++] = src[i * ordSrc + j];
                 }
             }
-            
-            rowCont++;
         }
     }
     
     return minimo;
 }
 
-double Matrix::deter(std::vector<std::vector<double> > m, size_t n)
+template <typename T>
+T BasicMatrix<T>::deter(const T *m, size_t n)
 {
     if(n == 1)
-        return m[0][0];
+        return m[0];
 
     if(n == 2)
     {
-        double mainDiag = m[0][0] * m[1][1];
-        double negDiag = m[1][0] * m[0][1];
+        T mainDiag = m[0] * m[3];
+        T negDiag = m[2] * m[1];
 
         return mainDiag - negDiag; 
     }
+    else if(n == 3)
+    {
+        return m[0]*m[4]*m[8] +
+            m[1]*m[5]*m[6] + 
+            m[2]*m[3]*m[7] - 
+            m[6]*m[4]*m[2] - 
+            m[7]*m[5]*m[0] - 
+            m[8]*m[1]*m[3];
+    }
     else
     {
-        double det = 0;
-        for(int J = 0; J < n; J++)
+        T det = T(0);
+        for(size_t J = 0; J < n; J++)
         {
-            std::vector< std::vector<double> > min = getMinimo( m, 0, J, n);
+            std::vector<T> min = getMinimo( m, 0, J, n);
             if((J % 2) == 0)
             {
-                det += m[0][J] * deter( min, n-1);
+                det += m[J] * deter( min.data(), n-1);
             }
             else
             {
-                det -= m[0][J] * deter( min, n-1);
+                det -= m[J] * deter( min.data(), n-1);
             }
         }
         
         return det;
     }
-    
-    return 0;
 }
 
-Matrix Matrix::transpose()
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::transpose()
 {
-    Matrix transposedMatrix(mCols, mRows);
-    for(int r = 0; r < mRows; r++)
-    {
-        for(int c = 0; c < mCols; c++)
+    IVS_TRACE_SCOPE("Matrix::transpose");
+    IVS_TRACE_BYTES(2 * matrix.size() * sizeof(T));
+    
+    BasicMatrix transposedMatrix(mCols, mRows);
+    
+    // po blocich, aby zapisy do sloupcu zustaly v cache
+    const size_t tile = 32;
+    const T *src = data();
+    T *dst = transposedMatrix.data();
+    size_t rows = mRows;
+    size_t cols = mCols;
+    
+    auto transposeTileRows = [src, dst, rows, cols, tile](size_t firstTile, size_t lastTile) {
+        for(size_t r0 = firstTile * tile; r0 < std::min(lastTile * tile, rows); r0 += tile)
         {
-            transposedMatrix.set(c,r, matrix[r][c]);
+            for(size_t c0 = 0; c0 < cols; c0 += tile)
+            {
+                size_t r1 = std::min(r0 + tile, rows);
+                size_t c1 = std::min(c0 + tile, cols);
+                
+                for(size_t r = r0; r < r1; r++)
+                {
+                    const T *srcRow = src + r * cols;
+                    
+                    for(size_t c = c0; c < c1; c++)
+                    {
+                        dst[c * rows + r] = srcRow[c];
+                    }
+                }
+            }
         }
-    }
+    };
+    
+    size_t tileRows = (mRows + tile - 1) / tile;
+    
+    if(matrix.size() < g_parallelThreshold.load(std::memory_order_relaxed))
+        transposeTileRows(0, tileRows);
+    else
+        TaskScheduler::instance().parallelFor(tileRows, transposeTileRows);
 
     return transposedMatrix;
 }
 
-Matrix Matrix::inverse()
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::inverse()
 {
-    Matrix inversedMatrix(mRows, mCols);
+    IVS_TRACE_SCOPE("Matrix::inverse");
+    IVS_TRACE_BYTES(2 * matrix.size() * sizeof(T));
+    
+    BasicMatrix inversedMatrix(mRows, mCols);
 
-    if(!(mRows == 2 && mCols == 2) && !(mRows == 3 && mCols == 3))
+    if(mRows != mCols || mRows < 2)
     {
-        throw std::runtime_error("Matice musi byt velikosti 2x2 nebo 3x3.");
+        throw std::runtime_error("Matice musi byt ctvercova a alespon 2x2.");
     }
 
-    double deter = determinant();
-    if( abs(deter) < std::numeric_limits<double>::epsilon() )
+    size_t kl = lowerBandwidth();
+    size_t ku = upperBandwidth();
+    
+    if(kl == 0 || ku == 0)
+    {
+        IVS_TRACE_FLOPS(mRows * mRows * mRows / 3);
+        return inverseTriangular(kl, ku);
+    }
+
+    if(mRows > 3)
+    {
+        typedef typename MatrixTraits<T>::WorkType W;
+        
+        IVS_TRACE_FLOPS(8 * mRows * mRows * mRows / 3);
+        
+        BlockedLU<W> lu = luFactorize(matrix.data(), mRows);
+        
+        if(lu.isSingular())
+            throw std::runtime_error("Matice je singularni.");
+        
+        std::vector<W> values = lu.inverse();
+        
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            inversedMatrix.matrix[i] = MatrixTraits<T>::fromWork(values[i]);
+        }
+        
+        return inversedMatrix;
+    }
+
+    T deter = determinant();
+    if( MatrixTraits<T>::isZero(deter) )
     {
         throw std::runtime_error("Matice je singularni.");
     }
 
+    const BasicMatrix &a = *this;
+
     if(mRows == 2 && mCols == 2)
     {
-        inversedMatrix.set(0, 0, matrix[1][1] / deter);
-        inversedMatrix.set(1, 0, -1.0 * matrix[1][0] / deter);
-        inversedMatrix.set(0, 1, -1.0 * matrix[0][1] / deter);
-        inversedMatrix.set(1, 1, matrix[0][0] / deter);
+        inversedMatrix(0, 0) = a(1, 1) / deter;
+        inversedMatrix(1, 0) = -a(1, 0) / deter;
+        inversedMatrix(0, 1) = -a(0, 1) / deter;
+        inversedMatrix(1, 1) = a(0, 0) / deter;
+    }
+    else
+    {
+        for(size_t r = 0; r < mRows; r++)
+        {
+            for(size_t c = 0; c < mCols; c++)
+            {
+                inversedMatrix(c, r) = (a((r+1)%3, (c+1)%3)*a((r+2)%3, (c+2)%3) - a((r+2)%3, (c+1)%3)*a((r+1)%3, (c+2)%3)) / deter;
+            }
+        }
+    }
+
+    return inversedMatrix;
+}
+
+template <typename T>
+size_t BasicMatrix<T>::lowerBandwidth() const
+{
+    size_t bandwidth = 0;
+    
+    for(size_t r = 1; r < mRows; r++)
+    {
+        const T *values = row(r);
+        
+        // staci hledat dal od diagonaly nez je dosavadni sirka pasu
+        for(size_t c = 0; c + bandwidth < r && c < mCols; c++)
+        {
+            if(values[c] != T(0))
+            {
+                bandwidth = r - c;
+                break;
+            }
+        }
+    }
+    
+    return bandwidth;
+}
+
+template <typename T>
+size_t BasicMatrix<T>::upperBandwidth() const
+{
+    size_t bandwidth = 0;
+    
+    for(size_t r = 0; r < mRows; r++)
+    {
+        const T *values = row(r);
+        
+        for(size_t c = mCols - 1; c > r + bandwidth; c--)
+        {
+            if(values[c] != T(0))
+            {
+                bandwidth = c - r;
+                break;
+            }
+        }
+    }
+    
+    return bandwidth;
+}
+
+template <typename T>
+typename BasicMatrix<T>::Structure_t BasicMatrix<T>::structure() const
+{
+    if(mRows != mCols)
+        return GENERAL;
+    
+    size_t kl = lowerBandwidth();
+    size_t ku = upperBandwidth();
+    
+    if(kl == 0 && ku == 0)
+        return DIAGONAL;
+    
+    if(kl == 0)
+        return UPPER_TRIANGULAR;
+    
+    if(ku == 0)
+        return LOWER_TRIANGULAR;
+    
+    if(isNarrowBand(mRows, kl, ku))
+        return BANDED;
+    
+    return GENERAL;
+}
+
+template <typename T>
+std::vector<T> BasicMatrix<T>::solveBanded(const std::vector<T> &b, size_t kl, size_t ku)
+{
+    typedef typename MatrixTraits<T>::WorkType W;
+    
+    size_t n = mRows;
+    std::vector<W> x(b.begin(), b.end());
+    
+    if(kl == 0)
+    {
+        for(size_t i = n; i-- > 0;)
+        {
+            const T *values = row(i);
+            W diag = W(values[i]);
+            
+            if(MatrixTraits<W>::isZero(diag))
+                throw std::runtime_error("Matice je singularni.");
+            
+            W sum = x[i];
+            size_t last = std::min(n - 1, i + ku);
+            
+            for(size_t j = i + 1; j <= last; j++)
+                sum -= W(values[j]) * x[j];
+            
+            x[i] = sum / diag;
+        }
+    }
+    else if(ku == 0)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            const T *values = row(i);
+            W diag = W(values[i]);
+            
+            if(MatrixTraits<W>::isZero(diag))
+                throw std::runtime_error("Matice je singularni.");
+            
+            W sum = x[i];
+            
+            for(size_t j = i > kl ? i - kl : 0; j < i; j++)
+                sum -= W(values[j]) * x[j];
+            
+            x[i] = sum / diag;
+        }
     }
     else
     {
-        for(int r = 0; r < mRows; r++)
+        // prohozeni radku muze rozsirit horni pas az na kl + ku
+        std::vector<W> lu(matrix.begin(), matrix.end());
+        size_t width = kl + ku;
+        
+        for(size_t j = 0; j < n; j++)
         {
-            for(int c = 0; c < mCols; c++)
+            size_t last = std::min(n - 1, j + kl);
+            size_t colLast = std::min(n - 1, j + width);
+            size_t p = j;
+            
+            for(size_t i = j + 1; i <= last; i++)
+            {
+                if(std::abs(lu[i * n + j]) > std::abs(lu[p * n + j]))
+                    p = i;
+            }
+            
+            if(MatrixTraits<W>::isZero(lu[p * n + j]))
+                throw std::runtime_error("Matice je singularni.");
+            
+            if(p != j)
             {
-                inversedMatrix.set(c, r, (matrix[(r+1)%3][(c+1)%3]*matrix[(r+2)%3][(c+2)%3] - matrix[(r+2)%3][(c+1)%3]*matrix[(r+1)%3][(c+2)%3]) / deter);
+                std::swap_ranges(&lu[j * n + j], &lu[j * n + colLast] + 1, &lu[p * n + j]);
+                std::swap(x[j], x[p]);
+            }
+            
+            for(size_t i = j + 1; i <= last; i++)
+            {
+                W l = lu[i * n + j] / lu[j * n + j];
+                
+                if(l == W(0))
+                    continue;
+                
+                for(size_t c = j + 1; c <= colLast; c++)
+                    lu[i * n + c] -= l * lu[j * n + c];
+                
+                x[i] -= l * x[j];
             }
         }
+        
+        for(size_t i = n; i-- > 0;)
+        {
+            W sum = x[i];
+            size_t last = std::min(n - 1, i + width);
+            
+            for(size_t c = i + 1; c <= last; c++)
+                sum -= lu[i * n + c] * x[c];
+            
+            x[i] = sum / lu[i * n + i];
+        }
     }
+    
+    std::vector<T> res(n);
+    
+    for(size_t i = 0; i < n; i++)
+        res[i] = MatrixTraits<T>::fromWork(x[i]);
+    
+    return res;
+}
 
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::inverseTriangular(size_t kl, size_t ku)
+{
+    typedef typename MatrixTraits<T>::WorkType W;
+    
+    size_t n = mRows;
+    BasicMatrix inversedMatrix(n, n);
+    const BasicMatrix &a = *this;
+    
+    for(size_t i = 0; i < n; i++)
+    {
+        if(MatrixTraits<W>::isZero(W(a(i, i))))
+            throw std::runtime_error("Matice je singularni.");
+    }
+    
+    if(kl == 0 && ku == 0)
+    {
+        for(size_t i = 0; i < n; i++)
+            inversedMatrix(i, i) = MatrixTraits<T>::fromWork(W(1) / W(a(i, i)));
+        
+        return inversedMatrix;
+    }
+    
+    // sloupec c inverze horni (dolni) trojuhelnikove matice je nenulovy
+    // pouze v radcich 0..c (c..n-1)
+    std::vector<W> x(n);
+    
+    for(size_t c = 0; c < n; c++)
+    {
+        x[c] = W(1) / W(a(c, c));
+        
+        if(kl == 0)
+        {
+            for(size_t i = c; i-- > 0;)
+            {
+                W sum = W(0);
+                size_t last = std::min(c, i + ku);
+                
+                for(size_t j = i + 1; j <= last; j++)
+                    sum += W(a(i, j)) * x[j];
+                
+                x[i] = -sum / W(a(i, i));
+            }
+            
+            for(size_t i = 0; i <= c; i++)
+                inversedMatrix(i, c) = MatrixTraits<T>::fromWork(x[i]);
+        }
+        else
+        {
+            for(size_t i = c + 1; i < n; i++)
+            {
+                W sum = W(0);
+                
+                for(size_t j = std::max(c, i > kl ? i - kl : 0); j < i; j++)
+                    sum += W(a(i, j)) * x[j];
+                
+                x[i] = -sum / W(a(i, i));
+            }
+            
+            for(size_t i = c; i < n; i++)
+                inversedMatrix(i, c) = MatrixTraits<T>::fromWork(x[i]);
+        }
+    }
+    
     return inversedMatrix;
 }
 
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::multiplyChain(const std::vector<BasicMatrix> &matrices)
+{
+    size_t count = matrices.size();
+    
+    if(count == 0)
+        throw std::runtime_error("Retezec matic je prazdny.");
+    
+    for(size_t i = 0; i + 1 < count; i++)
+    {
+        if(matrices[i].mCols != matrices[i + 1].mRows)
+            throw std::runtime_error("Prvni matice musi stejny pocet sloupcu jako druha radku.");
+    }
+    
+    if(count == 1)
+        return matrices[0];
+    
+    // dynamicke programovani, cost[i][j] je nejmensi pocet nasobeni pro
+    // soucin matic i..j a split[i][j] misto jeho rozdeleni
+    std::vector<double> cost(count * count, 0);
+    std::vector<size_t> split(count * count, 0);
+    
+    for(size_t len = 2; len <= count; len++)
+    {
+        for(size_t i = 0; i + len <= count; i++)
+        {
+            size_t j = i + len - 1;
+            
+            cost[i * count + j] = std::numeric_limits<double>::infinity();
+            
+            for(size_t k = i; k < j; k++)
+            {
+                double c = cost[i * count + k] + cost[(k + 1) * count + j] +
+                    double(matrices[i].mRows) * matrices[k].mCols * matrices[j].mCols;
+                
+                if(c < cost[i * count + j])
+                {
+                    cost[i * count + j] = c;
+                    split[i * count + j] = k;
+                }
+            }
+        }
+    }
+    
+    // mezivysledky jsou ukladany do dvojice matic pro kazdou uroven stromu
+    // zavorkovani, sourozenecke podstromy tak sdili tytez buffery
+    std::vector<BasicMatrix> buffers(2 * count);
+    BasicMatrix result;
+    
+    evalChain(matrices, split, 0, count - 1, result, buffers, 0);
+    
+    return result;
+}
+
+template <typename T>
+void BasicMatrix<T>::evalChain(const std::vector<BasicMatrix> &matrices, const std::vector<size_t> &split,
+                               size_t i, size_t j, BasicMatrix &result, std::vector<BasicMatrix> &buffers,
+                               size_t depth)
+{
+    size_t count = matrices.size();
+    size_t k = split[i * count + j];
+    
+    const BasicMatrix *left = &matrices[i];
+    const BasicMatrix *right = &matrices[k + 1];
+    
+    if(k > i)
+    {
+        evalChain(matrices, split, i, k, buffers[2 * depth], buffers, depth + 1);
+        left = &buffers[2 * depth];
+    }
+    
+    if(j > k + 1)
+    {
+        evalChain(matrices, split, k + 1, j, buffers[2 * depth + 1], buffers, depth + 1);
+        right = &buffers[2 * depth + 1];
+    }
+    
+    left->multiplyInto(*right, result);
+}
+
+template <typename T>
+void BasicMatrix<T>::setParallelThreshold(size_t elements)
+{
+    g_parallelThreshold.store(elements, std::memory_order_relaxed);
+}
+
+template <typename T>
+size_t BasicMatrix<T>::parallelThreshold()
+{
+    return g_parallelThreshold.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void BasicMatrix<T>::swap(BasicMatrix &m)
+{
+    matrix.swap(m.matrix);
+    std::swap(mRows, m.mRows);
+    std::swap(mCols, m.mCols);
+}
+
+template <typename T>
+void BasicMatrix<T>::resize(size_t row, size_t col)
+{
+    mRows = row;
+    mCols = col;
+    
+    // resize nealokuje, pokud staci kapacita z drivejsiho pouziti
+    matrix.clear();
+    matrix.resize(row * col);
+    zeroFill(matrix.data(), matrix.size());
+}
+
+// Explicitni instance pro podporovane typy prvku, jadra jsou prelozena
+// zvlast pro kazdy typ
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
+template class BasicMatrix<int32_t>;
+template class BasicMatrix<int64_t>;
+template class BasicMatrix<std::complex<double> >;
+
 /*** Konec souboru white_box_code.cpp ***/
\ No newline at end of file
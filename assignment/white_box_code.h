@@ -22,23 +22,163 @@
 #ifndef MATRIX_H_
 #define MATRIX_H_
 
+#include <cassert>
+#include <memory>
+#include <new>
 #include <utility>
 #include <vector>
 #include <limits>
 #include <cmath>
+#include <complex>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief Vlastnosti skalarniho typu prvku matice
+ * Obecna verze pro realna cisla s plovouci radovou carkou (float, double).
+ */
+template <typename T, bool isIntegral = std::is_integral<T>::value>
+struct MatrixTraits
+{
+  /**
+   * Typ, ve kterem se pocita LU dekompozice
+   */
+  typedef T WorkType;
+
+  /**
+   * @brief      fromWork
+   *      * prevede hodnotu z typu WorkType zpet na typ prvku matice
+   */
+  static T fromWork(const WorkType &value)
+  {
+    return value;
+  }
+
+  /**
+   * @brief      isZero
+   *      * zjisti zda je hodnota (napr. determinant) nulova
+   *
+   * @param      value  testovana hodnota
+   *
+   * @return     pokud je hodnota mensi nez strojove epsilon vrati true, jinak false
+   */
+  static bool isZero(const T &value)
+  {
+    return std::abs(value) < std::numeric_limits<T>::epsilon();
+  }
+};
+
+/**
+ * @brief Vlastnosti celociselnych typu prvku matice
+ * Nulova je pouze presna nula, deleni (inverze, reseni rovnic) je celociselne,
+ * LU dekompozice pro matice vyssich radu se pocita v double a zaokrouhluje.
+ */
+template <typename T>
+struct MatrixTraits<T, true>
+{
+  typedef double WorkType;
+
+  static T fromWork(const WorkType &value)
+  {
+    return static_cast<T>(std::llround(value));
+  }
+
+  static bool isZero(const T &value)
+  {
+    return value == 0;
+  }
+};
+
+/**
+ * @brief Vlastnosti komplexnich typu prvku matice
+ * Nulovost se posuzuje podle absolutni hodnoty (modulu) cisla.
+ */
+template <typename T>
+struct MatrixTraits<std::complex<T>, false>
+{
+  typedef std::complex<T> WorkType;
+
+  static std::complex<T> fromWork(const WorkType &value)
+  {
+    return value;
+  }
+
+  static bool isZero(const std::complex<T> &value)
+  {
+    return std::abs(value) < std::numeric_limits<T>::epsilon();
+  }
+};
+
+/**
+ * @brief Alokator prvku matice
+ * Prvky bez netrivialniho konstruktoru (cisla) pri vytvoreni neinicializuje,
+ * matice je nuluje sama, velke matice paralelne po blocich radku. Stranky
+ * pameti se tak fyzicky alokuji (first touch) na NUMA uzlu vlakna, ktere
+ * dany blok radku zpracovava i v paralelnich operacich.
+ */
+template <typename T>
+struct MatrixAllocator : public std::allocator<T>
+{
+  template <typename U>
+  struct rebind
+  {
+    typedef MatrixAllocator<U> other;
+  };
+
+  MatrixAllocator() noexcept {}
+
+  template <typename U>
+  MatrixAllocator(const MatrixAllocator<U> &) noexcept {}
+
+  template <typename U>
+  void construct(U *p)
+  {
+    ::new(static_cast<void *>(p)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *p, Args &&... args)
+  {
+    ::new(static_cast<void *>(p)) U(std::forward<Args>(args)...);
+  }
+};
 
 /**
  * @brief Trida reprezuntiji matici
  * 
+ * @tparam     T  skalarni typ prvku matice (float, double, std::complex<double>,
+ *                celociselne typy)
  */
-class Matrix
+template <typename T>
+class BasicMatrix
 {
 public:
+  typedef T value_type;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+
+  /**
+   * Souvisle ulozeni prvku matice po radcich
+   */
+  typedef std::vector<T, MatrixAllocator<T> > Storage_t;
+
+  /**
+   * @brief The Structure_t enum
+   * Struktura nenulovych prvku ctvercove matice.
+   */
+  enum Structure_t {
+    GENERAL,            ///< Obecna (plna) matice.
+    DIAGONAL,           ///< Nenulove prvky pouze na diagonale.
+    UPPER_TRIANGULAR,   ///< Horni trojuhelnikova matice.
+    LOWER_TRIANGULAR,   ///< Dolni trojuhelnikova matice.
+    BANDED              ///< Pasova matice s uzkym pasem kolem diagonaly.
+  };
+
   /**
    * @brief Matrix
    * Kontruktor vytvori nulovou matici velikosti 1x1
    */
-  Matrix();
+  BasicMatrix();
   /**
    * @brief Matrix
    * Kontruktor vytvori nulovou matici velikosti row x col
@@ -46,13 +186,23 @@ public:
    * @param      row    radek matice
    * @param      col    sloupec matice
    */
-  Matrix(size_t row, size_t col);
+  BasicMatrix(size_t row, size_t col);
+  /**
+   * @brief Matrix
+   * Kontruktor prevezme prvky matice velikosti row x col ulozene po radcich
+   * bez jejich kopirovani
+   *
+   * @param      row    radek matice
+   * @param      col    sloupec matice
+   * @param      values prvky matice, musi jich byt row * col
+   */
+  BasicMatrix(size_t row, size_t col, Storage_t &&values);
 
   /**
    * @brief Matrix
    * Destruktor
    */
-  ~Matrix();
+  ~BasicMatrix();
   /**
    * @brief      set
    *      * nastavi hodnotu v matici na pozici x,y
@@ -63,7 +213,7 @@ public:
    *
    * @return     pokud bylo vlozeni uspesne vrati true, jinak false
    */
-  bool set(size_t row, size_t col, double value);
+  bool set(size_t row, size_t col, T value);
   /**
    * @brief      set
    *      * nastavi matici hodnotami z pole
@@ -72,7 +222,7 @@ public:
    *
    * @return     pokud bylo vlozeni uspesne vrati true, jinak false
    */
-  bool set(std::vector<std::vector< double > > values);
+  bool set(std::vector<std::vector< T > > values);
   /**
    * @brief      get
    *      * vrati hodnotu v matici na pozici x,y 
@@ -81,27 +231,29 @@ public:
    *
    * @return     hodnota v matici na pozici x,y
    */
-  double get(size_t row, size_t col);
+  T get(size_t row, size_t col);
 
     /**
    * @brief      porovnani
-   *        * porovna obe matice
+   *        * porovna obe matice, velke matice paralelne (viz
+   *          setParallelThreshold), po prvni nalezene rozdilnosti
+   *          ostatni vlakna porovnavani ukonci
    *
    * @param      Matrix - matice pro porovnani
    *
    * @return     pokud jsou matice shodne tak vrati true, jinak false
    */
-  bool operator==(const Matrix) const;
+  bool operator==(const BasicMatrix &) const;
 
   /**
    * @brief      scitani
-   *        * secte dve matice
+   *        * secte dve matice, velke matice paralelne (viz setParallelThreshold)
    *
    * @param      Matrix - druhy scitanec
    *
    * @return     vysledna matice po secteni matic
    */
-  Matrix operator+(const Matrix) const;
+  BasicMatrix operator+(const BasicMatrix &) const;
 
   /**
    * @brief      nasobeni
@@ -111,52 +263,252 @@ public:
    *
    * @return     vysledna matice po vynasobeni matic
    */
-  Matrix operator*(const Matrix) const;
+  BasicMatrix operator*(const BasicMatrix &) const;
+
+  /**
+   * @brief      nasobeni do existujici matice
+   *        * vynasobi matice a vysledek ulozi do result, jehoz pamet se
+   *          znovu pouzije (alokuje se jen pokud je mensi nez vysledek);
+   *          nulove dlazdice a prvky se preskakuji jen proti konecnym
+   *          hodnotam, 0 * Inf a 0 * NaN tak dava NaN jako podle definice
+   *
+   * @param      m      - druhy cinitel
+   * @param      result - vysledna matice, nesmi byt zadnym z cinitelu
+   */
+  void multiplyInto(const BasicMatrix &m, BasicMatrix &result) const;
+
+  /**
+   * @brief      mocnina matice
+   *        * umocneni ctvercove matice metodou opakovaneho umocnovani na druhou,
+   *          mezivysledky se stridaji ve dvou pomocnych maticich
+   *
+   * @param      k - exponent, pro 0 vrati jednotkovou matici
+   *
+   * @return     matice umocnena na k
+   */
+  BasicMatrix pow(unsigned k) const;
+
+  /**
+   * @brief      soucin retezce matic
+   *        * zavorkovani s nejmensim poctem nasobeni je urceno dynamickym
+   *          programovanim, mezivysledky sdili pomocne matice po urovnich
+   *
+   * @param      matrices - matice A1..An
+   *
+   * @return     soucin A1 * A2 * ... * An
+   */
+  static BasicMatrix multiplyChain(const std::vector<BasicMatrix> &matrices);
+
+  /**
+   * @brief      setParallelThreshold
+   *        * nastavi pocet prvku, od ktereho se operace po prvcich (+, * skalar,
+   *          ==, transpose) a nulovani novych matic deli mezi vlakna planovace
+   *          (TaskScheduler::instance()), nastaveni plati pro vsechny typy prvku
+   *
+   * @param      elements - nejmensi pocet prvku matice pro paralelni zpracovani
+   */
+  static void setParallelThreshold(size_t elements);
+
+  /**
+   * @brief      parallelThreshold
+   *
+   * @return     nejmensi pocet prvku matice pro paralelni zpracovani
+   */
+  static size_t parallelThreshold();
+
+  /**
+   * @brief      swap
+   *        * prohodi obsah dvou matic bez kopirovani prvku
+   *
+   * @param      m - matice pro prohozeni
+   */
+  void swap(BasicMatrix &m);
 
   /**
    * @brief      skalarni nasobeni
-   *        * vynasobi matici skalarni hodnotou
+   *        * vynasobi matici skalarni hodnotou, velke matice paralelne
+   *          (viz setParallelThreshold)
    *
    * @param      value - skalarni cinitel
    *
    * @return     vysledna matice po vynasobeni matice skalarem
    */
-  Matrix operator*(const double value) const;
+  BasicMatrix operator*(const T value) const;
+
+  /**
+   * @brief      nasobeni vektorem (GEMV)
+   *        * vypocte y = A * x, radky se zpracovavaji po ctyrech (ctyri
+   *          nezavisle soucty nad jednim ctenim x), velke matice paralelne
+   *          po blocich radku (viz setParallelThreshold)
+   *
+   * @param      x - vektor o poctu prvku rovnem poctu sloupcu matice
+   *
+   * @return     vektor y o poctu prvku rovnem poctu radku matice
+   */
+  std::vector<T> operator*(const std::vector<T> &x) const;
+
+  /**
+   * @brief      nasobeni vektorem bez alokace
+   *        * vypocte y = A * x nad existujicimi poli, velikosti nekontroluje
+   *
+   * @param      x - mCols prvku
+   * @param      y - mRows prvku, vystup (nesmi se prekryvat s x)
+   */
+  void multiplyVector(const T *x, T *y) const;
+
+  /**
+   * @brief      nasobeni transponovanou matici (GEMV^T)
+   *        * vypocte y = A^T * x bez transpozice matice, radky A se pricitaji
+   *          k y po ctyrech, velke matice paralelne po blocich sloupcu
+   *          (kazde vlakno vlastni cast y, bez synchronizace)
+   *
+   * @param      x - vektor o poctu prvku rovnem poctu radku matice
+   *
+   * @return     vektor y o poctu prvku rovnem poctu sloupcu matice
+   */
+  std::vector<T> multiplyTransposed(const std::vector<T> &x) const;
+
+  /**
+   * @brief      nasobeni transponovanou matici bez alokace
+   *        * vypocte y = A^T * x nad existujicimi poli, velikosti nekontroluje
+   *
+   * @param      x - mRows prvku
+   * @param      y - mCols prvku, vystup (nesmi se prekryvat s x)
+   */
+  void multiplyTransposedVector(const T *x, T *y) const;
 
   /**
    * @brief      reseni spoustavy linearnich rovnic
-   *        * soustava rovnic je resena pomoci cramerova pravidla
+   *        * diagonalni, trojuhelnikove a pasove matice jsou reseny primo
+   *          dosazovanim (O(n), O(n^2), O(n * sirka pasu^2)), ostatni
+   *          soustavy radu nejvyse 3 pomoci cramerova pravidla a vyssi
+   *          rady pomoci paralelni blokove LU dekompozice
    *
    * @param      b prava strana rovnice
    *
    * @return     pole vysledku x1, x2, ...
    */
-  std::vector<double> solveEquation(std::vector<double> b);
+  std::vector<T> solveEquation(std::vector<T> b);
 
   /**
    * @brief      vypocet transponovane matice A^T
-   *        * prehozeni indexu
+   *        * prehozeni indexu po dlazdicich, velke matice paralelne po
+   *          blocich radku dlazdic (viz setParallelThreshold)
    *
    * @return     transponovana matici
    */
-  Matrix transpose();
+  BasicMatrix transpose();
 
   /**
    * @brief      vypocet invertovane matice A^-1
+   *        * diagonalni matice v O(n), trojuhelnikove dosazovanim, ostatni
+   *          matice radu vyssiho nez 3 pomoci LU dekompozice
    *
    * @return     invertovana matici
    */
-  Matrix inverse();
+  BasicMatrix inverse();
 
+  /**
+   * @brief      lowerBandwidth
+   *
+   * @return     nejvetsi vzdalenost nenuloveho prvku pod diagonalou od diagonaly
+   */
+  size_t lowerBandwidth() const;
 
+  /**
+   * @brief      upperBandwidth
+   *
+   * @return     nejvetsi vzdalenost nenuloveho prvku nad diagonalou od diagonaly
+   */
+  size_t upperBandwidth() const;
 
+  /**
+   * @brief      structure
+   *        * zjisti strukturu nenulovych prvku matice, pro plnou matici
+   *          skonci po prvnim a poslednim prvku kazdeho radku
+   *
+   * @return     struktura matice, pro obdelnikove matice vzdy GENERAL
+   */
+  Structure_t structure() const;
+
+  /**
+   * @brief      nekontrolovany pristup
+   *        * vrati referenci na prvek na pozici row,col bez kontroly mezi,
+   *          kontrola je pouze assert v ladicim sestaveni (bez NDEBUG)
+   *
+   * @param      row    radek matice
+   * @param      col    sloupec matice
+   *
+   * @return     reference na prvek matice
+   */
+  T &operator()(size_t row, size_t col)
+  {
+    assert(row < mRows && col < mCols);
+    return matrix[row * mCols + col];
+  }
+
+  const T &operator()(size_t row, size_t col) const
+  {
+    assert(row < mRows && col < mCols);
+    return matrix[row * mCols + col];
+  }
+
+  /**
+   * @brief      data
+   *
+   * @return     ukazatel na souvisle pole prvku ulozenych po radcich
+   */
+  T *data() { return matrix.data(); }
+
+  const T *data() const { return matrix.data(); }
+
+  /**
+   * @brief      row
+   *
+   * @param      row   radek matice
+   *
+   * @return     ukazatel na prvni prvek radku (prvky radku jsou souvisle)
+   */
+  T *row(size_t row)
+  {
+    assert(row < mRows);
+    return matrix.data() + row * mCols;
+  }
 
+  const T *row(size_t row) const
+  {
+    assert(row < mRows);
+    return matrix.data() + row * mCols;
+  }
+
+  /**
+   * @brief      rows
+   *
+   * @return     pocet radku matice
+   */
+  size_t rows() const { return mRows; }
+
+  /**
+   * @brief      cols
+   *
+   * @return     pocet sloupcu matice
+   */
+  size_t cols() const { return mCols; }
+
+  /**
+   * @brief      begin, end
+   *        * iteratory pres vsechny prvky matice po radcich
+   */
+  iterator begin() { return matrix.data(); }
+  iterator end() { return matrix.data() + matrix.size(); }
+  const_iterator begin() const { return matrix.data(); }
+  const_iterator end() const { return matrix.data() + matrix.size(); }
 
 protected:
   /**
-   * 2D pole reprezentujici matici
+   * Prvky matice ulozene souvisle po radcich (mRows x mCols)
    */
-  std::vector<std::vector<double> > matrix;
+  Storage_t matrix;
 
   size_t mRows;
   
@@ -179,7 +531,7 @@ protected:
    *
    * @return     Pokud maji matice shodnou velikost vrati true, jinak false
    */
-  bool checkEqualSize(const Matrix m) const;
+  bool checkEqualSize(const BasicMatrix &m) const;
 
   /**
    * @brief      kontrola zda je matice ctvercova
@@ -189,21 +541,85 @@ protected:
   bool checkSquare();
   /**
    * @brief      vypocte dereminant matice
+   *        * pro matice radu vyssiho nez 3 pomoci LU dekompozice
    *
    * @return     Vrati hodnotu determinantu matice
    */
-  double determinant();
+  T determinant();
 
   /**
    * @brief      Pomocna funkce pro vypocet determinantu matice vyssich radu
    *
-   * param       m matice 
+   * param       m matice ulozena po radcich
    * param       n rad matice 
    * @return     Vrati hodnotu determinantu matice
    */
-  double deter(std::vector<std::vector<double> > m, size_t n);
+  T deter(const T *m, size_t n);
+
+  /**
+   * @brief      zmeni velikost matice a vynuluje ji, pamet se znovu pouzije
+   *        * velke matice nuluji paralelne vlakna planovace po blocich radku
+   *
+   * param       row pocet radku
+   * param       col pocet sloupcu
+   */
+  void resize(size_t row, size_t col);
+
+  /**
+   * @brief      vypocte soucin matic i..j retezce podle tabulky rozdeleni
+   *
+   * param       matrices retezec matic
+   * param       split    misto rozdeleni soucinu i..j (na indexu i * n + j)
+   * param       result   vysledna matice
+   * param       buffers  pomocne matice, dvojice pro kazdou uroven
+   * param       depth    uroven ve stromu zavorkovani
+   */
+  static void evalChain(const std::vector<BasicMatrix> &matrices, const std::vector<size_t> &split,
+                        size_t i, size_t j, BasicMatrix &result, std::vector<BasicMatrix> &buffers,
+                        size_t depth);
+
+  /**
+   * @brief      reseni soustavy s pasovou matici
+   *        * kl == 0 zpetne dosazeni, ku == 0 dopredne dosazeni, jinak
+   *          gaussova eliminace s castecnou pivotaci omezena na pas
+   *
+   * param       b  prava strana rovnice
+   * param       kl sirka pasu pod diagonalou
+   * param       ku sirka pasu nad diagonalou
+   * @return     pole vysledku x1, x2, ...
+   */
+  std::vector<T> solveBanded(const std::vector<T> &b, size_t kl, size_t ku);
+
+  /**
+   * @brief      inverze trojuhelnikove (pripadne diagonalni) matice
+   *
+   * param       kl sirka pasu pod diagonalou (0 pro horni trojuhelnikovou)
+   * param       ku sirka pasu nad diagonalou (0 pro dolni trojuhelnikovou)
+   * @return     invertovana matice
+   */
+  BasicMatrix inverseTriangular(size_t kl, size_t ku);
 };
 
+/**
+ * Matice s prvky typu double (puvodni rozhrani)
+ */
+typedef BasicMatrix<double> Matrix;
+
+/**
+ * Matice s prvky typu float (polovicni pametova narocnost, dvojnasobna sirka SIMD)
+ */
+typedef BasicMatrix<float> MatrixFloat;
+
+/**
+ * Matice s 64-bitovymi celociselnymi prvky
+ */
+typedef BasicMatrix<int64_t> MatrixInt64;
+
+/**
+ * Matice s komplexnimi prvky
+ */
+typedef BasicMatrix<std::complex<double> > MatrixComplex;
+
 
 
 #endif /* MATRIX_H_ */
@@ -13,8 +13,19 @@
  * @brief Implementace testu prace s maticemi.
  */
 
+#include <cmath>
+#include <limits>
+#include <numeric>
+
 #include "gtest/gtest.h"
 #include "white_box_code.h"
+#include "lu_decomposition.h"
+#include "matrix_io.h"
+#include "instrumentation.h"
+#include "alloc_tracker.h"
+#include "numa_topology.h"
+#include "matrix_jobs.h"
+#include "packed_matrix.h"
 
 //============================================================================//
 // ** ZDE DOPLNTE TESTY **
@@ -34,8 +45,8 @@ template <size_t rows, size_t cols>
 Matrix static_array_to_matrix(double (&value)[rows][cols]) {
     Matrix mat = Matrix(rows, cols);
 
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
             mat.set(i, j, value[i][j]);
         }
     }
@@ -775,4 +786,1065 @@ TEST_F(MatrixTest, inverse)
 }
 
 
+/***
+ * other element types
+ */
+
+class MatrixTypesTest : public ::testing::Test {
+
+};
+
+TEST_F(MatrixTypesTest, floatMatrix)
+{
+    MatrixFloat a = MatrixFloat(2, 2);
+    MatrixFloat b = MatrixFloat(2, 2);
+
+    EXPECT_TRUE(a.set({ {1.5f, 2}, {-3, 4} }));
+    EXPECT_TRUE(b.set({ {2, 0}, {1, 0.5f} }));
+
+    auto res = a * b;
+
+    EXPECT_FLOAT_EQ(res.get(0, 0), 5);
+    EXPECT_FLOAT_EQ(res.get(0, 1), 1);
+    EXPECT_FLOAT_EQ(res.get(1, 0), -2);
+    EXPECT_FLOAT_EQ(res.get(1, 1), 2);
+
+    auto inv = a.inverse();
+
+    EXPECT_NEAR(inv.get(0, 0), 4 / 12.0f, 0.0001);
+    EXPECT_NEAR(inv.get(1, 0), 3 / 12.0f, 0.0001);
+}
+
+TEST_F(MatrixTypesTest, int64Matrix)
+{
+    MatrixInt64 a = MatrixInt64(3, 3);
+
+    EXPECT_TRUE(a.set({ {2, 0, 0}, {0, 3, 0}, {0, 0, 4} }));
+
+    auto res = a * a + a * 2;
+
+    EXPECT_EQ(res.get(0, 0), 8);
+    EXPECT_EQ(res.get(1, 1), 15);
+    EXPECT_EQ(res.get(2, 2), 24);
+    EXPECT_EQ(res.get(0, 1), 0);
+
+    std::vector<int64_t> x = a.solveEquation({ 4, 9, 16 });
+
+    EXPECT_EQ(x[0], 2);
+    EXPECT_EQ(x[1], 3);
+    EXPECT_EQ(x[2], 4);
+
+    MatrixInt64 singular = MatrixInt64(2, 2);
+    EXPECT_THROW(singular.inverse(), std::runtime_error);
+}
+
+TEST_F(MatrixTypesTest, complexMatrix)
+{
+    typedef std::complex<double> C;
+
+    MatrixComplex a = MatrixComplex(2, 2);
+
+    EXPECT_TRUE(a.set({ {C(0, 1), C(1, 0)}, {C(1, 0), C(0, 1)} }));
+
+    auto inv = a.inverse();
+    auto id = a * inv;
+
+    EXPECT_NEAR(std::abs(id.get(0, 0) - C(1, 0)), 0, 0.00001);
+    EXPECT_NEAR(std::abs(id.get(0, 1)), 0, 0.00001);
+    EXPECT_NEAR(std::abs(id.get(1, 0)), 0, 0.00001);
+    EXPECT_NEAR(std::abs(id.get(1, 1) - C(1, 0)), 0, 0.00001);
+
+    EXPECT_TRUE(a.transpose() == a);
+}
+
+/***
+ * blocked LU for higher orders
+ */
+
+class MatrixLUTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp() {
+        //diagonally dominant, so well conditioned but needs pivoting in the first column
+        mat = Matrix(n, n);
+
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                mat.set(i, j, ((i * 7 + j * 13) % 11) - 5.0);
+            }
+
+            mat.set(i, i, 4.0 * n + i);
+        }
+
+        mat.set(0, 0, 0.0);
+    }
+
+    static const int n = 70;
+    Matrix mat;
+};
+
+TEST_F(MatrixLUTest, solveEquation)
+{
+    std::vector< double > b;
+
+    for (int i = 0; i < n; i++) {
+        b.push_back(i - 20.5);
+    }
+
+    auto x = mat.solveEquation(b);
+
+    for (int i = 0; i < n; i++) {
+        double sum = 0;
+
+        for (int j = 0; j < n; j++) {
+            sum += mat.get(i, j) * x[j];
+        }
+
+        EXPECT_NEAR(sum, b[i], 0.00001);
+    }
+}
+
+TEST_F(MatrixLUTest, inverse)
+{
+    auto id = mat * mat.inverse();
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            EXPECT_NEAR(id.get(i, j), i == j ? 1.0 : 0.0, 0.00001);
+        }
+    }
+
+    //singular
+    auto singular = Matrix(n, n);
+    EXPECT_THROW(singular.inverse(), std::runtime_error);
+    EXPECT_THROW(singular.solveEquation(std::vector< double >(n, 1)), std::runtime_error);
+}
+
+TEST_F(MatrixLUTest, blockedDeterminant)
+{
+    //small blocks, so the whole task graph runs
+    double array[5][5] = {
+        {0, 2, 1, 4, 3},
+        {1, 1, 0, 2, 1},
+        {3, 0, 2, 1, 0},
+        {2, 1, 1, 0, 5},
+        {1, 4, 0, 3, 2}
+    };
+
+    std::vector< double > values;
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            values.push_back(array[i][j]);
+        }
+    }
+
+    BlockedLU<double> whole(values.data(), 5);
+    BlockedLU<double> blocked(values.data(), 5, 2);
+
+    EXPECT_FALSE(blocked.isSingular());
+    EXPECT_NEAR(blocked.determinant(), whole.determinant(), 0.00001);
+    EXPECT_NEAR(blocked.determinant(), -172, 0.00001);
+
+    std::vector< double > inv = blocked.inverse();
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            double sum = 0;
+
+            for (int k = 0; k < 5; k++) {
+                sum += array[i][k] * inv[k * 5 + j];
+            }
+
+            EXPECT_NEAR(sum, i == j ? 1.0 : 0.0, 0.00001);
+        }
+    }
+}
+
+/***
+ * unchecked access and iterators
+ */
+
+TEST_F(Matrix3x6, uncheckedAccess)
+{
+    EXPECT_EQ(mat.rows(), 3u);
+    EXPECT_EQ(mat.cols(), 6u);
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 6; j++) {
+            EXPECT_DOUBLE_EQ(mat(i, j), mat.get(i, j));
+            EXPECT_DOUBLE_EQ(mat.row(i)[j], mat.get(i, j));
+            EXPECT_DOUBLE_EQ(mat.data()[i * 6 + j], mat.get(i, j));
+        }
+    }
+
+    mat(2, 5) = 1.5;
+    EXPECT_DOUBLE_EQ(mat.get(2, 5), 1.5);
+
+    const Matrix &constMat = mat;
+    EXPECT_DOUBLE_EQ(constMat(2, 5), 1.5);
+}
+
+TEST_F(Matrix2x2, iterators)
+{
+    EXPECT_EQ(std::distance(mat.begin(), mat.end()), 4);
+    EXPECT_DOUBLE_EQ(std::accumulate(mat.begin(), mat.end(), 0.0), 119);
+
+    std::fill(mat.begin(), mat.end(), 2.0);
+    EXPECT_DOUBLE_EQ(mat.get(1, 0), 2.0);
+
+    std::vector< double > copy(mat.begin(), mat.end());
+    EXPECT_EQ(copy.size(), 4u);
+}
+
+/***
+ * structured matrices
+ */
+
+class MatrixStructureTest : public ::testing::Test
+{
+protected:
+    /**
+     * Matrix n x n with values only in band [i - kl, i + ku] around diagonal
+     */
+    Matrix band(int n, int kl, int ku) {
+        Matrix mat = Matrix(n, n);
+
+        for (int i = 0; i < n; i++) {
+            for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); j++) {
+                mat.set(i, j, i == j ? 10.0 + i : 1.0 + ((i + 2 * j) % 5));
+            }
+        }
+
+        return mat;
+    }
+
+    /**
+     * Check A * x == b
+     */
+    void checkSolution(Matrix &mat, std::vector< double > &x, std::vector< double > &b) {
+        for (size_t i = 0; i < b.size(); i++) {
+            double sum = 0;
+
+            for (size_t j = 0; j < b.size(); j++) {
+                sum += mat.get(i, j) * x[j];
+            }
+
+            EXPECT_NEAR(sum, b[i], 0.00001);
+        }
+    }
+};
+
+TEST_F(MatrixStructureTest, detect)
+{
+    EXPECT_EQ(band(6, 0, 0).structure(), Matrix::DIAGONAL);
+    EXPECT_EQ(band(6, 0, 5).structure(), Matrix::UPPER_TRIANGULAR);
+    EXPECT_EQ(band(6, 3, 0).structure(), Matrix::LOWER_TRIANGULAR);
+    EXPECT_EQ(band(40, 1, 2).structure(), Matrix::BANDED);
+    EXPECT_EQ(band(6, 2, 2).structure(), Matrix::GENERAL);
+    EXPECT_EQ(Matrix(2, 3).structure(), Matrix::GENERAL);
+
+    Matrix mat = band(40, 1, 2);
+    EXPECT_EQ(mat.lowerBandwidth(), 1u);
+    EXPECT_EQ(mat.upperBandwidth(), 2u);
+}
+
+TEST_F(MatrixStructureTest, solveEquation)
+{
+    int shapes[4][3] = {
+        {7, 0, 0},
+        {7, 0, 6},
+        {7, 4, 0},
+        {60, 2, 3}
+    };
+
+    for (int s = 0; s < 4; s++) {
+        Matrix mat = band(shapes[s][0], shapes[s][1], shapes[s][2]);
+        std::vector< double > b;
+
+        for (int i = 0; i < shapes[s][0]; i++) {
+            b.push_back(i % 3 - 1.5);
+        }
+
+        std::vector< double > x = mat.solveEquation(b);
+        checkSolution(mat, x, b);
+    }
+
+    //singular triangular
+    Matrix singular = band(5, 0, 2);
+    singular.set(3, 3, 0);
+    EXPECT_THROW(singular.solveEquation(std::vector< double >(5, 1)), std::runtime_error);
+}
+
+TEST_F(MatrixStructureTest, inverse)
+{
+    int shapes[3][3] = {
+        {7, 0, 0},
+        {7, 0, 6},
+        {7, 4, 0}
+    };
+
+    for (int s = 0; s < 3; s++) {
+        Matrix mat = band(shapes[s][0], shapes[s][1], shapes[s][2]);
+        Matrix id = mat * mat.inverse();
+
+        for (int i = 0; i < shapes[s][0]; i++) {
+            for (int j = 0; j < shapes[s][0]; j++) {
+                EXPECT_NEAR(id.get(i, j), i == j ? 1.0 : 0.0, 0.00001);
+            }
+        }
+    }
+}
+
+TEST_F(MatrixStructureTest, blockMultiply)
+{
+    //block diagonal with zero tiles, compare with definition
+    int n = 150;
+    Matrix a = Matrix(n, n);
+    Matrix b = band(n, 3, 1);
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i / 70 == j / 70) {
+                a.set(i, j, (i * 3 + j) % 7 - 3.0);
+            }
+        }
+    }
+
+    Matrix res = a * b;
+
+    for (int i = 0; i < n; i += 7) {
+        for (int j = 0; j < n; j += 3) {
+            double sum = 0;
+
+            for (int k = 0; k < n; k++) {
+                sum += a.get(i, k) * b.get(k, j);
+            }
+
+            EXPECT_DOUBLE_EQ(res.get(i, j), sum);
+        }
+    }
+}
+
+TEST_F(MatrixStructureTest, blockMultiplyNonFinite)
+{
+    //skipped zeros must not hide 0 * Inf and 0 * NaN
+    int n = 150;
+    double inf = std::numeric_limits<double>::infinity();
+    Matrix a = Matrix(n, n);
+    Matrix b = Matrix(n, n);
+
+    for (int i = 0; i < n; i++) {
+        b.set(i, i, 1);
+    }
+
+    //zero tile of a against Inf in b, zero element of a against NaN in b
+    b.set(10, 5, inf);
+    b.set(100, 120, std::numeric_limits<double>::quiet_NaN());
+    a.set(100, 120, 2);
+
+    Matrix res = a * b;
+
+    EXPECT_TRUE(std::isnan(res.get(0, 5)));
+    EXPECT_TRUE(std::isnan(res.get(100, 120)));
+    EXPECT_EQ(res.get(100, 121), 0);
+
+    //Inf in a against zero tile of b
+    Matrix c = Matrix(n, n);
+    c.set(3, 140, -inf);
+
+    res = c * Matrix(n, n);
+
+    EXPECT_TRUE(std::isnan(res.get(3, 0)));
+    EXPECT_EQ(res.get(4, 0), 0);
+}
+
+/***
+ * power and chain multiplication
+ */
+
+TEST_F(MatrixTest, pow)
+{
+    double fib[2][2] = {
+        {1, 1},
+        {1, 0}
+    };
+    auto mat = static_array_to_matrix(fib);
+
+    double res10[2][2] = {
+        {89, 55},
+        {55, 34}
+    };
+    EXPECT_EQ(mat.pow(10), static_array_to_matrix(res10));
+    EXPECT_EQ(mat.pow(1), mat);
+
+    double id[2][2] = {
+        {1, 0},
+        {0, 1}
+    };
+    EXPECT_EQ(mat.pow(0), static_array_to_matrix(id));
+
+    EXPECT_EQ(mat.pow(7), mat * mat * mat * mat * mat * mat * mat);
+
+    EXPECT_THROW(Matrix(2, 3).pow(2), std::runtime_error);
+}
+
+TEST_F(MatrixTest, multiplyInto)
+{
+    double a[2][3] = {
+        {1, 2, 3},
+        {4, 5, 6}
+    };
+    double b[3][2] = {
+        {1, 0},
+        {0, 1},
+        {1, 1}
+    };
+    auto matA = static_array_to_matrix(a);
+    auto matB = static_array_to_matrix(b);
+
+    //result of different size is resized
+    Matrix res = Matrix(5, 5);
+    matA.multiplyInto(matB, res);
+    EXPECT_EQ(res, matA * matB);
+
+    EXPECT_THROW(matA.multiplyInto(matB, matA), std::runtime_error);
+    EXPECT_THROW(matA.multiplyInto(matA, res), std::runtime_error);
+}
+
+TEST_F(MatrixTest, multiplyChain)
+{
+    std::vector< Matrix > chain;
+    size_t dims[6] = { 10, 30, 5, 60, 3, 7 };
+
+    for (int m = 0; m < 5; m++) {
+        Matrix mat = Matrix(dims[m], dims[m + 1]);
+
+        for (size_t i = 0; i < dims[m]; i++) {
+            for (size_t j = 0; j < dims[m + 1]; j++) {
+                mat.set(i, j, (i + 2 * j + m) % 5 - 2.0);
+            }
+        }
+
+        chain.push_back(mat);
+    }
+
+    Matrix expected = chain[0] * chain[1] * chain[2] * chain[3] * chain[4];
+    EXPECT_EQ(Matrix::multiplyChain(chain), expected);
+
+    std::vector< Matrix > single(1, chain[2]);
+    EXPECT_EQ(Matrix::multiplyChain(single), chain[2]);
+
+    EXPECT_THROW(Matrix::multiplyChain(std::vector< Matrix >()), std::runtime_error);
+
+    chain.push_back(Matrix(2, 2));
+    EXPECT_THROW(Matrix::multiplyChain(chain), std::runtime_error);
+}
+
+/***
+ * loading from text
+ */
+
+TEST_F(MatrixTest, parseText)
+{
+    const char text[] = "1.5, -2, 3e2\n\n4;5\t6\r\n  7 8 9";
+
+    auto mat = parseMatrixText<double>(text, sizeof(text) - 1);
+
+    double res_mat[3][3] = {
+        {1.5, -2, 300},
+        {4,   5,  6},
+        {7,   8,  9}
+    };
+    EXPECT_EQ(mat, static_array_to_matrix(res_mat));
+
+    //same result with parallel parsing of row ranges
+    EXPECT_EQ(parseMatrixText<double>(text, sizeof(text) - 1, 4), mat);
+
+    auto ints = parseMatrixText<int64_t>("1 2\n3 4\n", 8);
+    EXPECT_EQ(ints.get(1, 0), 3);
+
+    const char ragged[] = "1 2\n3\n";
+    EXPECT_THROW(parseMatrixText<double>(ragged, sizeof(ragged) - 1), std::runtime_error);
+
+    const char invalid[] = "1 2x\n3 4\n";
+    EXPECT_THROW(parseMatrixText<double>(invalid, sizeof(invalid) - 1), std::runtime_error);
+
+    EXPECT_THROW(parseMatrixText<double>(" \n\n", 3), std::runtime_error);
+
+    //empty CSV fields, even when every row misses the same one
+    const char missing[] = "1,,3\n4,,6\n7,,9\n";
+    EXPECT_THROW(parseMatrixText<double>(missing, sizeof(missing) - 1), std::runtime_error);
+    EXPECT_THROW(parseMatrixText<double>(missing, sizeof(missing) - 1, 3), std::runtime_error);
+    EXPECT_THROW(parseMatrixText<double>(",1,2\n", 6), std::runtime_error);
+    EXPECT_THROW(parseMatrixText<double>("1,2, \n", 7), std::runtime_error);
+    EXPECT_THROW(parseMatrixText<double>("1; ;2\n", 7), std::runtime_error);
+
+    //parallel ranges write into their slices of one storage
+    std::string big;
+    for (int r = 0; r < 200; r++) {
+        for (int c = 0; c < 5; c++) {
+            big += std::to_string(r * 5 + c) + (c < 4 ? "," : "\n");
+        }
+
+        if (r % 17 == 0) {
+            big += "\n";
+        }
+    }
+
+    auto parallel = parseMatrixText<int32_t>(big.data(), big.size(), 7);
+    EXPECT_EQ(parallel, parseMatrixText<int32_t>(big.data(), big.size(), 1));
+    EXPECT_EQ(parallel.get(199, 4), 999);
+    EXPECT_EQ(parallel.get(57, 2), 287);
+}
+
+TEST_F(MatrixTest, loadText)
+{
+    std::string path = ::testing::TempDir() + "white_box_matrix.csv";
+    FILE *file = fopen(path.c_str(), "w");
+    ASSERT_TRUE(file != NULL);
+
+    for (int i = 0; i < 300; i++) {
+        for (int j = 0; j < 40; j++) {
+            fprintf(file, j ? ",%d.25" : "%d.25", i - j);
+        }
+
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+
+    auto mat = loadMatrixText<double>(path.c_str());
+    auto parallel = loadMatrixText<double>(path.c_str(), 3);
+
+    EXPECT_EQ(mat.rows(), 300u);
+    EXPECT_EQ(mat.cols(), 40u);
+    EXPECT_DOUBLE_EQ(mat.get(299, 39), 260.25);
+    EXPECT_EQ(mat, parallel);
+
+    remove(path.c_str());
+
+    EXPECT_THROW(loadMatrixText<double>(path.c_str()), std::runtime_error);
+}
+
+/***
+ * allocations in hot paths
+ */
+
+TEST_F(MatrixTest, multiplyIntoAllocations)
+{
+    Matrix a(100, 100);
+    Matrix b(100, 100);
+    Matrix res(100, 100);
+
+    for (size_t i = 0; i < 100; i++) {
+        a(i, i) = 2;
+        b(i, 99 - i) = 3;
+    }
+
+    //first call sizes the thread local scratch buffers
+    a.multiplyInto(b, res);
+
+    AllocTracker tracker;
+    a.multiplyInto(b, res);
+    b.multiplyInto(a, res);
+
+    EXPECT_EQ(tracker.allocations(), 0u);
+    EXPECT_DOUBLE_EQ(res.get(0, 99), 6);
+
+    //operators allocate only the result storage
+    tracker.restart();
+    Matrix sum = a + b;
+    Matrix scaled = a * 2.0;
+
+    EXPECT_EQ(tracker.allocations(), 2u);
+    EXPECT_EQ(tracker.bytes(), 2 * 100 * 100 * sizeof(double));
+}
+
+/***
+ * NUMA placement
+ */
+
+TEST(NumaTopologyTest, parseCpuList)
+{
+    std::vector<unsigned> expected = { 0, 1, 2, 3, 8, 10, 11 };
+
+    EXPECT_EQ(NumaTopology::parseCpuList("0-3,8,10-11\n"), expected);
+    EXPECT_TRUE(NumaTopology::parseCpuList("\n").empty());
+
+    const NumaTopology &topology = NumaTopology::instance();
+
+    ASSERT_GE(topology.nodes(), 1u);
+    EXPECT_FALSE(topology.cpus(0).empty());
+    EXPECT_EQ(topology.nodeOf(0, 8), 0u);
+    EXPECT_LT(topology.nodeOf(7, 8), topology.nodes());
+}
+
+TEST(TaskSchedulerTest, parallelFor)
+{
+    TaskScheduler scheduler(4);
+    std::vector<int> visited(1003, 0);
+    size_t parts = 0;
+
+    scheduler.parallelFor(visited.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            visited[i]++;
+        }
+    });
+
+    EXPECT_EQ(std::count(visited.begin(), visited.end(), 1), 1003);
+
+    scheduler.parallelFor(2, [&](size_t first, size_t last) {
+        EXPECT_EQ(last, first + 1);
+    });
+    scheduler.parallelFor(0, [&](size_t, size_t) { parts++; });
+
+    EXPECT_EQ(parts, 0u);
+}
+
+TEST_F(MatrixTest, firstTouchZeroFill)
+{
+    //large enough to be zeroed in parallel
+    Matrix big(700, 400);
+
+    EXPECT_TRUE(std::all_of(big.begin(), big.end(), [](double v) { return v == 0; }));
+
+    std::fill(big.begin(), big.end(), 7.0);
+
+    Matrix a(700, 1);
+    Matrix b(1, 400);
+    a.multiplyInto(b, big);
+
+    EXPECT_EQ(big.rows(), 700u);
+    EXPECT_TRUE(std::all_of(big.begin(), big.end(), [](double v) { return v == 0; }));
+}
+
+TEST_F(MatrixTest, parallelElementwise)
+{
+    Matrix a(130, 90);
+    Matrix b(130, 90);
+
+    for (size_t i = 0; i < a.rows(); i++) {
+        for (size_t j = 0; j < a.cols(); j++) {
+            a(i, j) = double(i * 1000 + j);
+            b(i, j) = double(j) - double(i);
+        }
+    }
+
+    Matrix sum = a + b;
+    Matrix scaled = a * 3.0;
+    Matrix transposed = a.transpose();
+
+    size_t threshold = Matrix::parallelThreshold();
+    Matrix::setParallelThreshold(1);
+
+    EXPECT_EQ(Matrix::parallelThreshold(), 1u);
+    EXPECT_EQ(a + b, sum);
+    EXPECT_EQ(a * 3.0, scaled);
+    EXPECT_EQ(a.transpose(), transposed);
+    EXPECT_DOUBLE_EQ(transposed.get(89, 129), 129089);
+
+    Matrix copy = a;
+    EXPECT_TRUE(copy == a);
+
+    copy(129, 89) = -1;
+    EXPECT_FALSE(copy == a);
+
+    copy(129, 89) = a(129, 89);
+    copy(0, 0) = -1;
+    EXPECT_FALSE(copy == a);
+
+    Matrix::setParallelThreshold(threshold);
+}
+
+TEST_F(MatrixTest, multiplyVector)
+{
+    Matrix a(37, 23);
+
+    for (size_t i = 0; i < a.rows(); i++) {
+        for (size_t j = 0; j < a.cols(); j++) {
+            a(i, j) = double(i) * 0.5 - double(j) + 1;
+        }
+    }
+
+    std::vector<double> x(a.cols());
+    std::vector<double> z(a.rows());
+    Matrix xm(a.cols(), 1);
+    Matrix zm(a.rows(), 1);
+
+    for (size_t j = 0; j < x.size(); j++) {
+        x[j] = double(j % 5) - 2;
+        xm(j, 0) = x[j];
+    }
+
+    for (size_t i = 0; i < z.size(); i++) {
+        z[i] = double(i % 3) + 1;
+        zm(i, 0) = z[i];
+    }
+
+    Matrix ax = a * xm;
+    Matrix atz = a.transpose() * zm;
+
+    size_t threshold = Matrix::parallelThreshold();
+
+    for (size_t pass = 0; pass < 2; pass++) {
+        //second pass uses parallel kernels
+        Matrix::setParallelThreshold(pass == 0 ? threshold : 1);
+
+        std::vector<double> y = a * x;
+        std::vector<double> yt = a.multiplyTransposed(z);
+
+        ASSERT_EQ(y.size(), a.rows());
+        ASSERT_EQ(yt.size(), a.cols());
+
+        for (size_t i = 0; i < y.size(); i++) {
+            EXPECT_DOUBLE_EQ(y[i], ax(i, 0));
+        }
+
+        for (size_t j = 0; j < yt.size(); j++) {
+            EXPECT_DOUBLE_EQ(yt[j], atz(j, 0));
+        }
+
+        std::vector<double> out(a.rows(), -1);
+        a.multiplyVector(x.data(), out.data());
+        EXPECT_EQ(out, y);
+
+        out.assign(a.cols(), -1);
+        a.multiplyTransposedVector(z.data(), out.data());
+        EXPECT_EQ(out, yt);
+    }
+
+    Matrix::setParallelThreshold(threshold);
+
+    //every row (also the tail rows after blocks of four) sums in source order
+    Matrix c(7, 5);
+    double big[5] = { 1e16, 1, -1e16, 1, 3 };
+
+    for (size_t i = 0; i < c.rows(); i++) {
+        for (size_t j = 0; j < c.cols(); j++) {
+            c(i, j) = big[(i + j) % 5];
+        }
+    }
+
+    std::vector<double> ones(c.cols(), 1);
+    std::vector<double> yc = c * ones;
+
+    for (size_t i = 0; i < c.rows(); i++) {
+        double sum = 0;
+
+        for (size_t j = 0; j < c.cols(); j++) {
+            sum += c(i, j);
+        }
+
+        EXPECT_EQ(yc[i], sum);
+    }
+
+    EXPECT_ANY_THROW(a * z);
+    EXPECT_ANY_THROW(a.multiplyTransposed(x));
+    EXPECT_ANY_THROW(a * std::vector<double>());
+}
+
+/***
+ * asynchronous jobs
+ */
+
+TEST_F(MatrixTest, jobQueue)
+{
+    std::vector< Matrix > mats;
+    std::vector< std::future< std::vector< double > > > solves;
+    std::vector< double > b = { 1, 2, 3, 4, 5 };
+
+    {
+        //capacity 3 forces producer to wait for batches
+        MatrixJobQueue queue(3, 2);
+
+        for (int k = 0; k < 10; k++) {
+            Matrix mat(5, 5);
+
+            for (size_t i = 0; i < 5; i++) {
+                for (size_t j = 0; j < 5; j++) {
+                    mat(i, j) = (i == j) ? 10.0 + k : double((i + 2 * j + k) % 4);
+                }
+            }
+
+            mats.push_back(mat);
+            solves.push_back(queue.submitSolve(mat, b));
+        }
+
+        auto inverse = queue.submitInverse(mats[0]);
+        auto product = queue.submitMultiply(mats[0], mats[1]);
+        auto singular = queue.submitInverse(Matrix(4, 4));
+        auto badSolve = queue.submitSolve(mats[0], std::vector< double >(2, 1.0));
+
+        EXPECT_EQ(product.get(), mats[0] * mats[1]);
+        EXPECT_EQ(inverse.get(), mats[0].inverse());
+        EXPECT_THROW(singular.get(), std::runtime_error);
+        EXPECT_THROW(badSolve.get(), std::runtime_error);
+
+        for (size_t k = 0; k < solves.size(); k++) {
+            std::vector< double > expected = mats[k].solveEquation(b);
+            std::vector< double > x = solves[k].get();
+
+            ASSERT_EQ(x.size(), expected.size());
+
+            for (size_t i = 0; i < x.size(); i++) {
+                EXPECT_DOUBLE_EQ(x[i], expected[i]);
+            }
+        }
+
+        queue.wait();
+        EXPECT_EQ(queue.pending(), 0u);
+
+        //destructor finishes accepted jobs
+        solves[0] = queue.submitSolve(mats[3], b);
+    }
+
+    EXPECT_EQ(solves[0].get(), mats[3].solveEquation(b));
+}
+
+TEST_F(MatrixTest, jobQueueNoHeadOfLineBlocking)
+{
+    //own scheduler, so there are worker threads even on a single CPU
+    TaskScheduler scheduler(4);
+    MatrixJobQueue queue(16, 4, scheduler);
+
+    size_t n = 320;
+    Matrix big(n, n);
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            big(i, j) = double((i * 7 + j) % 5) + 1;
+        }
+    }
+
+    auto slow = queue.submitMultiply(big, big);
+
+    double small[2][2] = {
+        {4, 7},
+        {2, 6}
+    };
+    auto fast = queue.submitInverse(static_array_to_matrix(small));
+
+    //small job does not wait for the batch submitted before it
+    EXPECT_EQ(fast.get(), static_array_to_matrix(small).inverse());
+    EXPECT_EQ(slow.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+    EXPECT_EQ(slow.get(), big * big);
+    queue.wait();
+    EXPECT_EQ(queue.pending(), 0u);
+}
+
+/***
+ * packed storage
+ */
+
+class PackedMatrixTest : public ::testing::Test
+{
+protected:
+    /**
+     * Soucin plne matice a vektoru
+     */
+    std::vector< double > denseMultiply(const Matrix &mat, const std::vector< double > &x) {
+        std::vector< double > y(mat.rows(), 0.0);
+
+        for (size_t i = 0; i < mat.rows(); i++) {
+            for (size_t j = 0; j < mat.cols(); j++) {
+                y[i] += mat(i, j) * x[j];
+            }
+        }
+
+        return y;
+    }
+
+    void expectNear(const std::vector< double > &a, const std::vector< double > &b) {
+        ASSERT_EQ(a.size(), b.size());
+
+        for (size_t i = 0; i < a.size(); i++) {
+            EXPECT_NEAR(a[i], b[i], 1e-9);
+        }
+    }
+
+    std::vector< double > x = { 1, -2, 3, 0.5, -1, 2 };
+};
+
+TEST_F(PackedMatrixTest, triangular)
+{
+    Matrix upper(6, 6);
+    Matrix lower(6, 6);
+
+    for (size_t i = 0; i < 6; i++) {
+        for (size_t j = i; j < 6; j++) {
+            upper(i, j) = (i == j) ? 4.0 + i : double(i + 2 * j) / 7.0;
+            lower(j, i) = upper(i, j) - 1.0;
+        }
+
+        lower(i, i) = 3.0 + i;
+    }
+
+    auto packedUpper = TriangularMatrix< double >::fromMatrix(upper, TriangularMatrix< double >::UPPER);
+    auto packedLower = TriangularMatrix< double >::fromMatrix(lower, TriangularMatrix< double >::LOWER);
+
+    EXPECT_EQ(packedUpper.toMatrix(), upper);
+    EXPECT_EQ(packedLower.toMatrix(), lower);
+    EXPECT_DOUBLE_EQ(packedUpper.get(1, 4), 9.0 / 7.0);
+    EXPECT_DOUBLE_EQ(packedUpper.get(4, 1), 0);
+
+    expectNear(packedUpper.multiply(x), denseMultiply(upper, x));
+    expectNear(packedLower.multiply(x), denseMultiply(lower, x));
+    expectNear(packedUpper.solve(denseMultiply(upper, x)), x);
+    expectNear(packedLower.solve(denseMultiply(lower, x)), x);
+
+    EXPECT_THROW(packedUpper.set(3, 2, 1.0), std::runtime_error);
+    EXPECT_THROW(TriangularMatrix< double >::fromMatrix(upper, TriangularMatrix< double >::LOWER),
+                 std::runtime_error);
+    EXPECT_THROW(TriangularMatrix< double >(3, TriangularMatrix< double >::UPPER).solve({ 1, 2, 3 }),
+                 std::runtime_error);
+}
+
+TEST_F(PackedMatrixTest, symmetric)
+{
+    SymmetricMatrix< double > sym(6);
+
+    for (size_t i = 0; i < 6; i++) {
+        for (size_t j = 0; j <= i; j++) {
+            //indefinite, but with nonzero leading minors
+            sym.set(j, i, (i == j) ? ((i % 2) ? -5.0 : 6.0) : double(i * j + 1) / 10.0);
+        }
+    }
+
+    Matrix full = sym.toMatrix();
+
+    EXPECT_DOUBLE_EQ(sym.get(1, 4), sym.get(4, 1));
+    EXPECT_EQ(SymmetricMatrix< double >::fromMatrix(full).toMatrix(), full);
+
+    expectNear(sym.multiply(x), denseMultiply(full, x));
+    expectNear(sym.solve(denseMultiply(full, x)), x);
+    expectNear(sym.solve(x), full.solveEquation(x));
+
+    full(0, 1) = 42;
+    EXPECT_THROW(SymmetricMatrix< double >::fromMatrix(full), std::runtime_error);
+    EXPECT_THROW(SymmetricMatrix< double >(2).solve({ 1, 1 }), std::runtime_error);
+}
+
+TEST_F(PackedMatrixTest, symmetricIndefinite)
+{
+    //zero leading minor, needs a 2x2 pivot block
+    SymmetricMatrix< double > swap(2);
+    swap.set(1, 0, 1.0);
+
+    expectNear(swap.solve({ 2, 3 }), { 3, 2 });
+
+    //tiny leading pivot, unpivoted LDL^T loses the solution
+    SymmetricMatrix< double > tiny(2);
+    tiny.set(0, 0, 1e-20);
+    tiny.set(1, 0, 1.0);
+    tiny.set(1, 1, 1.0);
+
+    expectNear(tiny.solve({ 2, 3 }), { 1, 2 });
+
+    //zero diagonal, every step pivots
+    SymmetricMatrix< double > sym(6);
+
+    for (size_t i = 0; i < 6; i++) {
+        for (size_t j = 0; j < i; j++) {
+            sym.set(i, j, double((i * 3 + j * 5) % 7) - 3.0);
+        }
+    }
+
+    Matrix full = sym.toMatrix();
+
+    expectNear(sym.solve(denseMultiply(full, x)), x);
+    expectNear(sym.solve(x), full.solveEquation(x));
+
+    SymmetricMatrix< std::complex< double > > complexSym(2);
+    complexSym.set(1, 0, std::complex< double >(0, 1));
+
+    std::vector< std::complex< double > > z = complexSym.solve({ 1, 1 });
+    EXPECT_NEAR(std::abs(z[0] - std::complex< double >(0, -1)), 0.0, 1e-12);
+    EXPECT_NEAR(std::abs(z[1] - std::complex< double >(0, -1)), 0.0, 1e-12);
+}
+
+TEST_F(PackedMatrixTest, banded)
+{
+    Matrix full(6, 6);
+
+    for (size_t i = 0; i < 6; i++) {
+        full(i, i) = 0.5;
+
+        if (i + 1 < 6) {
+            full(i + 1, i) = 2.0 + i;
+            full(i, i + 1) = -1.0;
+        }
+
+        if (i + 2 < 6) {
+            full(i, i + 2) = 0.25;
+        }
+    }
+
+    auto band = BandedMatrix< double >::fromMatrix(full);
+
+    EXPECT_EQ(band.lowerBandwidth(), 1u);
+    EXPECT_EQ(band.upperBandwidth(), 2u);
+    EXPECT_EQ(band.toMatrix(), full);
+    EXPECT_DOUBLE_EQ(band.get(5, 0), 0);
+
+    expectNear(band.multiply(x), denseMultiply(full, x));
+    //small diagonal forces row interchanges
+    expectNear(band.solve(denseMultiply(full, x)), x);
+
+    EXPECT_THROW(band.set(0, 5, 1.0), std::runtime_error);
+    EXPECT_THROW(BandedMatrix< double >::fromMatrix(full, 1, 1), std::runtime_error);
+}
+
+TEST_F(PackedMatrixTest, largeTridiagonal)
+{
+    const size_t n = 200000;
+    BandedMatrix< double > band(n, 1, 1);
+    std::vector< double > expected(n);
+
+    for (size_t i = 0; i < n; i++) {
+        band.set(i, i, 4.0);
+        expected[i] = double(i % 13) - 6.0;
+
+        if (i > 0) {
+            band.set(i, i - 1, -1.0);
+            band.set(i - 1, i, -1.0);
+        }
+    }
+
+    std::vector< double > solution = band.solve(band.multiply(expected));
+
+    for (size_t i = 0; i < n; i += 997) {
+        EXPECT_NEAR(solution[i], expected[i], 1e-9);
+    }
+}
+
+/***
+ * tracing counters
+ */
+
+TEST_F(MatrixTest, tracing)
+{
+    Instrumentation::reset();
+
+    Matrix a(8, 8);
+    Matrix b(8, 8);
+    Matrix c = a * b + a;
+
+    EXPECT_EQ(c.rows(), 8u);
+
+    std::string json = Instrumentation::toJson();
+    std::string perf = Instrumentation::toPerf();
+
+    if (Instrumentation::enabled()) {
+        EXPECT_NE(json.find("\"Matrix::operator+\": {\"calls\": 1,"), std::string::npos);
+        EXPECT_NE(json.find("\"flops\": 1024,"), std::string::npos);
+        EXPECT_NE(perf.find("Matrix::multiplyInto:flops"), std::string::npos);
+
+        Instrumentation::reset();
+        EXPECT_EQ(Instrumentation::toJson().find("\"calls\": 1,"), std::string::npos);
+    } else {
+        EXPECT_EQ(json, "{}");
+        EXPECT_EQ(perf, "");
+    }
+}
+
 /*** Konec souboru white_box_tests.cpp ***/